@@ -1,8 +1,9 @@
 #version 330 core
+#include "include/varying.glsl"
 
 layout(location = 0) out vec4 color;
 
-in vec2 v_texCoords;
+VARYING(2) in vec2 v_texCoords;
 uniform sampler2D texture1;
 
 void main() {
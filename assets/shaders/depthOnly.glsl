@@ -0,0 +1,22 @@
+#shader vertex
+#version 330 core
+
+// Reads positions only, so split stream meshes can bind just their position stream
+layout(location = 0) in vec3 position;
+
+uniform mat4 u_viewProjection;
+uniform mat4 u_model;
+// Instances are laid out in grid of u_columns columns, same as packedVertices.glsl
+uniform int u_columns;
+uniform float u_spacing;
+
+void main() {
+    vec3 instanceOffset = vec3(gl_InstanceID % u_columns, 0.0, gl_InstanceID / u_columns) * u_spacing;
+    gl_Position = u_viewProjection * (u_model * vec4(position, 1.0) + vec4(instanceOffset, 0.0));
+}
+
+#shader fragment
+#version 330 core
+
+void main() {
+}
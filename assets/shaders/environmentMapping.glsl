@@ -9,8 +9,12 @@ out vec3 v_normal;
 out vec3 v_fragPos;
 out vec2 v_texCoords;
 
-uniform mat4 projection;
-uniform mat4 view;
+// Shared by all shaders, updated once per frame (FrameUniforms)
+layout(std140) uniform FrameConstants {
+    mat4 projection;
+    mat4 view;
+    vec3 viewPosition;
+};
 uniform mat4 model;
 
 void main() {
@@ -75,12 +79,19 @@ in vec3 v_fragPos;
 in vec2 v_texCoords;
 
 uniform Material material;
-uniform DirectionalLight dirLight;
-uniform PointLight pointLight;
-uniform SpotLight spotLight;
-// Alternatively we can calculate lighting in view space, this uniform becaumes 0,0,0 always and is not needed
+// std140 layout, must match LightConstants in FrameUniforms.hpp
+layout(std140) uniform LightConstants {
+    DirectionalLight dirLight;
+    PointLight pointLight;
+    SpotLight spotLight;
+};
+// Alternatively we can calculate lighting in view space, viewPosition becomes 0,0,0 always and is not needed
 // but we need to convert all relevant vectors, view matrix and normal matrix if used
-uniform vec3 viewPosition;
+layout(std140) uniform FrameConstants {
+    mat4 projection;
+    mat4 view;
+    vec3 viewPosition;
+};
 
 // These methods are absolutely not optimal, contains a lot of duplication
 vec3 calculateDirLight(DirectionalLight light, vec3 normal, vec3 viewDirection);
@@ -0,0 +1,30 @@
+// 3x3 convolution around texCoords, included by post processing shaders
+
+// For kernel effects, feel free to tweak
+const float kernelOffset = 1.0 / 300.0;
+
+// Takes the nine samples once, so every enabled kernel reuses them
+void sampleKernel(sampler2D tex, vec2 texCoords, out vec3 samples[9]) {
+    vec2 offsets[9] = vec2[] (
+        vec2(-kernelOffset, kernelOffset), // top-left
+        vec2(   0.0f, kernelOffset), // top-center
+        vec2( kernelOffset, kernelOffset), // top-right
+        vec2(-kernelOffset, 0.0f), // center-left
+        vec2(   0.0f, 0.0f), // center-center
+        vec2( kernelOffset, 0.0f), // center-right
+        vec2(-kernelOffset, -kernelOffset), // bottom-left
+        vec2(   0.0f, -kernelOffset), // bottom-center
+        vec2( kernelOffset, -kernelOffset) // bottom-right
+    );
+    for (int i = 0; i < 9; i++) {
+        samples[i] = vec3(texture(tex, texCoords + offsets[i]));
+    }
+}
+
+vec3 applyKernel(vec3 samples[9], float kernel[9]) {
+    vec3 result = vec3(0.0);
+    for (int i = 0; i < 9; i++) {
+        result += samples[i] * kernel[i];
+    }
+    return result;
+}
@@ -0,0 +1,8 @@
+// Vertex and fragment files combined into pipeline (see Shader) are compiled as separable programs with
+// SEPARABLE_PROGRAM defined. Those match stage interfaces by location, so fragment stage may read just some
+// of vertex stage outputs. Monolithic GLSL 330 programs have no varying locations and match them by name
+#ifdef SEPARABLE_PROGRAM
+#define VARYING(n) layout(location = n)
+#else
+#define VARYING(n)
+#endif
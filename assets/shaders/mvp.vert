@@ -1,15 +1,27 @@
 #version 330 core
+#include "include/varying.glsl"
 
 layout(location = 0) in vec3 position;
 layout(location = 1) in vec3 normal;
 layout(location = 2) in vec2 texCoords;
 
-out vec3 v_normal;
-out vec3 v_fragPos;
-out vec2 v_texCoords;
+VARYING(0) out vec3 v_normal;
+VARYING(1) out vec3 v_fragPos;
+VARYING(2) out vec2 v_texCoords;
 
-uniform mat4 projection;
-uniform mat4 view;
+#ifdef SEPARABLE_PROGRAM
+// Separable vertex stage must redeclare built-in outputs it writes
+out gl_PerVertex {
+    vec4 gl_Position;
+};
+#endif
+
+// Shared by all shaders, updated once per frame (FrameUniforms)
+layout(std140) uniform FrameConstants {
+    mat4 projection;
+    mat4 view;
+    vec3 viewPosition;
+};
 uniform mat4 model;
 
 void main() {
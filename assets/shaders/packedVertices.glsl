@@ -0,0 +1,47 @@
+#shader vertex
+#version 330 core
+
+// Works with both Vertex and PackedVertex: normalised attributes arrive as floats,
+// packed position is 0-1 inside mesh bounds and gets mapped back by model matrix.
+// Normals are not quantized by position bounds, so they use normal matrix of model without dequantization
+layout(location = 0) in vec3 position;
+layout(location = 1) in vec3 normal;
+layout(location = 2) in vec2 texCoords;
+
+out vec3 v_normal;
+out vec2 v_texCoords;
+
+uniform mat4 u_viewProjection;
+// Model transform with position dequantization folded in, identity dequantization for float vertices
+uniform mat4 u_model;
+// Inverse transpose of model transform alone, dequantization scale is not uniform and would skew normals
+uniform mat3 u_normalMatrix;
+// Offset in xy, scale in zw
+uniform vec4 u_texCoordTransform;
+// Instances are laid out in grid of u_columns columns
+uniform int u_columns;
+uniform float u_spacing;
+
+void main() {
+    vec3 instanceOffset = vec3(gl_InstanceID % u_columns, 0.0, gl_InstanceID / u_columns) * u_spacing;
+    gl_Position = u_viewProjection * (u_model * vec4(position, 1.0) + vec4(instanceOffset, 0.0));
+    v_normal = u_normalMatrix * normal;
+    v_texCoords = u_texCoordTransform.xy + u_texCoordTransform.zw * texCoords;
+}
+
+#shader fragment
+#version 330 core
+
+layout(location = 0) out vec4 color;
+
+in vec3 v_normal;
+in vec2 v_texCoords;
+
+uniform vec3 u_lightDirection;
+
+void main() {
+    float diffuse = max(dot(normalize(v_normal), -u_lightDirection), 0.0);
+    // Checker pattern shows texture coord precision
+    float checker = mod(floor(v_texCoords.x * 32.0) + floor(v_texCoords.y * 16.0), 2.0);
+    color = vec4(vec3(0.2 + 0.8 * diffuse) * mix(0.6, 1.0, checker), 1.0);
+}
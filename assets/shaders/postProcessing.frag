@@ -1,94 +1,70 @@
 #version 330 core
+#include "include/varying.glsl"
+
+// Effects are compiled in or out with defines (see ShaderPermutations):
+// INVERT_COLORS, GRAYSCALE, SHARPEN, BLUR, EDGE_DETECTION (or outline)
 
 layout(location = 0) out vec4 color;
 
-in vec2 v_texCoords;
+VARYING(2) in vec2 v_texCoords;
 uniform sampler2D texture1;
 
-uniform bool invertColors;
-uniform bool grayScale;
-uniform bool sharpen;
-uniform bool blur;
-uniform bool edgeDetection; // or outline
+#include "include/kernel.glsl"
 
-// For kernel effects, feel free to tweak
-const float offset = 1.0 / 300.0;
+#if defined(SHARPEN) || defined(BLUR) || defined(EDGE_DETECTION)
+#define KERNEL_EFFECTS
+#endif
 
 void main() {
     color = texture(texture1, v_texCoords);
 
-    if (invertColors) {
-        color = vec4(vec3(1.0 - texture(texture1, v_texCoords)), 1.0);
-    }
-
-    if (grayScale) {
-        // To create grayscale we simply average all colors
-        //float average = (color.r, color.g, color.b) / 3.0;
-        // Or to create results more precise to the human vision, we use weighted color channels, as human eyes
-        // sees more blue than red
-        float average = 0.2126 * color.r + 0.7152 * color.g + 0.0722 * color.b;
-        color = vec4(average, average, average, 1.0);
-    }
-
-    vec2 offsets[9] = vec2[] (
-        vec2(-offset, offset), // top-left
-        vec2(   0.0f, offset), // top-center
-        vec2( offset, offset), // top-right
-        vec2(-offset, 0.0f), // center-left
-        vec2(   0.0f, 0.0f), // center-center
-        vec2( offset, 0.0f), // center-right
-        vec2(-offset, -offset), // bottom-left
-        vec2(   0.0f, -offset), // bottom-center
-        vec2( offset, -offset) // bottom-right
-    );
-
+#ifdef INVERT_COLORS
+    color = vec4(vec3(1.0 - color), 1.0);
+#endif
+
+#ifdef GRAYSCALE
+    // To create grayscale we simply average all colors
+    //float average = (color.r, color.g, color.b) / 3.0;
+    // Or to create results more precise to the human vision, we use weighted color channels, as human eyes
+    // sees more blue than red
+    float average = 0.2126 * color.r + 0.7152 * color.g + 0.0722 * color.b;
+    color = vec4(average, average, average, 1.0);
+#endif
+
+#ifdef KERNEL_EFFECTS
+    // Nine taps are only taken when some kernel effect is compiled in
     vec3 sampleTex[9];
-    for (int i = 0; i < 9; i++) {
-        sampleTex[i] = vec3(texture(texture1, v_texCoords.st + offsets[i]));
-    }
+    sampleKernel(texture1, v_texCoords.st, sampleTex);
     vec3 col = vec3(0.0);
 
-    // Kernels (convolution matrix)
+    // Kernels (convolution matrix), results accumulate when more than one is enabled
+#ifdef SHARPEN
     float sharpenKernel[9] = float[] (
         -1, -1, -1,
         -1,  9, -1,
         -1, -1, -1
     );
+    col += applyKernel(sampleTex, sharpenKernel);
+#endif
 
+#ifdef BLUR
     float blurKernel[9] = float[] (
         1.0 / 16, 2.0 / 16, 1.0 / 16,
         2.0 / 16, 4.0 / 16, 2.0 / 16,
         1.0 / 16, 2.0 / 16, 1.0 / 16
     );
+    col += applyKernel(sampleTex, blurKernel);
+#endif
 
+#ifdef EDGE_DETECTION
     float edgeDetectionKernel[9] = float[] (
         1, 1, 1,
         1, -8, 1,
         1, 1, 1
     );
+    col += applyKernel(sampleTex, edgeDetectionKernel);
+#endif
 
-    // Kernel effects
-    if (sharpen) {
-        for (int i = 0; i < 9; i++) {
-            col += sampleTex[i] * sharpenKernel[i];
-        }
-
-        color = vec4(col, 1.0);
-    }
-
-    if (blur) {
-        for (int i = 0; i < 9; i++) {
-            col += sampleTex[i] * blurKernel[i];
-        }
-
-        color = vec4(col, 1.0);
-    }
-
-    if (edgeDetection) {
-        for (int i = 0; i < 9; i++) {
-            col += sampleTex[i] * edgeDetectionKernel[i];
-        }
-
-        color = vec4(col, 1.0);
-    }
+    color = vec4(col, 1.0);
+#endif
 }
@@ -1,8 +1,16 @@
 #version 330 core
+#include "include/varying.glsl"
 layout (location = 0) in vec2 position;
 layout (location = 1) in vec2 texCoords;
 
-out vec2 v_texCoords;
+VARYING(2) out vec2 v_texCoords;
+
+#ifdef SEPARABLE_PROGRAM
+// Separable vertex stage must redeclare built-in outputs it writes
+out gl_PerVertex {
+    vec4 gl_Position;
+};
+#endif
 
 void main() {
     gl_Position = vec4(position.x, position.y, 0.0, 1.0);
@@ -0,0 +1,337 @@
+#include "Benchmark.hpp"
+
+#include "Renderer.hpp"
+#include "GLState.hpp"
+#include "UploadQueue.hpp"
+#include "DeletionQueue.hpp"
+#include "GPUProfiler.hpp"
+#include "Camera.hpp"
+#include "PixelReadback.hpp"
+#include "ProgramCache.hpp"
+
+#include "glm/gtc/constants.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+
+namespace {
+    // Frames needed for one full orbit of scripted camera
+    const float ORBIT_FRAMES = 720.0f;
+    const float FIXED_DELTA_TIME = 1.0f / 60.0f;
+
+    void printUsage() {
+        std::cout << "Usage: OpenGLTest [--bench <test name>] [--frames N] [--warmup N] [--size WxH]"
+            " [--orbit radius] [--output file.json]\n"
+            "                  [--golden <dir> [--golden-frame N] [--tolerance T] [--max-mismatch F] [--update-golden]]\n"
+            "                  [--shader-cache <dir>, empty disables]\n";
+    }
+
+    // "Instanced drawing" -> "instanced_drawing"
+    std::string goldenFileName(const std::string& testName) {
+        std::string name;
+        for (char c : testName) {
+            if (std::isalnum(static_cast<unsigned char>(c)))
+                name += std::tolower(static_cast<unsigned char>(c));
+            else if (!name.empty() && name.back() != '_')
+                name += '_';
+        }
+        while (!name.empty() && name.back() == '_')
+            name.pop_back();
+        return name;
+    }
+
+    // Tests don't clean up after themselves (see FIXME in main), so same defaults as main sets up
+    // are restored between tests, otherwise result would depend on which test ran before
+    void resetGLState() {
+        GLCall(glBindFramebuffer(GL_FRAMEBUFFER, 0));
+        GLCall(glDisable(GL_DEPTH_TEST));
+        GLCall(glDisable(GL_STENCIL_TEST));
+        GLCall(glDisable(GL_CULL_FACE));
+        GLCall(glDepthMask(GL_TRUE));
+        GLCall(glEnable(GL_BLEND));
+        GLCall(glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
+    }
+
+    std::string escape(const std::string& text) {
+        std::string escaped;
+        for (char c : text) {
+            if (c == '"' || c == '\\')
+                escaped += '\\';
+            escaped += c;
+        }
+        return escaped;
+    }
+
+    // Nearest rank percentile, times must be sorted
+    float percentile(const std::vector<float>& times, float p) {
+        size_t rank = static_cast<size_t>(std::ceil(p * times.size()));
+        if (rank > 0)
+            rank--;
+        return times[std::min(rank, times.size() - 1)];
+    }
+}
+
+Benchmark::Benchmark(const BenchmarkOptions& options)
+    : options(options) {
+}
+
+bool Benchmark::parseArguments(int argc, char** argv, BenchmarkOptions& options) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--help" || arg == "-h") {
+            printUsage();
+            return false;
+        }
+        if (arg == "--update-golden") {
+            options.updateGolden = true;
+            continue;
+        }
+        if (!hasValue) {
+            std::cout << "Missing value for " << arg << "\n";
+            printUsage();
+            return false;
+        }
+
+        std::string value = argv[++i];
+        if (arg == "--bench") {
+            options.enabled = true;
+            options.testName = value;
+        } else if (arg == "--frames") {
+            options.frames = std::max(1, std::atoi(value.c_str()));
+        } else if (arg == "--warmup") {
+            options.warmupFrames = std::max(0, std::atoi(value.c_str()));
+        } else if (arg == "--size") {
+            if (std::sscanf(value.c_str(), "%dx%d", &options.width, &options.height) != 2
+                    || options.width <= 0 || options.height <= 0) {
+                std::cout << "Invalid size " << value << ", expected WxH\n";
+                return false;
+            }
+        } else if (arg == "--orbit") {
+            options.orbitRadius = std::atof(value.c_str());
+        } else if (arg == "--output") {
+            options.outputFile = value;
+        } else if (arg == "--golden") {
+            options.enabled = true;
+            options.goldenDir = value;
+        } else if (arg == "--golden-frame") {
+            options.goldenFrame = std::max(0, std::atoi(value.c_str()));
+        } else if (arg == "--tolerance") {
+            options.tolerance = std::max(0, std::atoi(value.c_str()));
+        } else if (arg == "--max-mismatch") {
+            options.maxMismatch = std::atof(value.c_str());
+        } else if (arg == "--shader-cache") {
+            options.shaderCacheDir = value;
+        } else {
+            std::cout << "Unknown argument " << arg << "\n";
+            printUsage();
+            return false;
+        }
+    }
+    return true;
+}
+
+int Benchmark::run(GLFWwindow* window, test::TestMenu& testMenu) {
+    std::vector<std::string> testNames;
+    if (options.testName.empty())
+        testNames = testMenu.getTestNames();
+    else
+        testNames.push_back(options.testName);
+
+    bool passed = true;
+    std::string json = testNames.size() > 1 ? "[\n" : "";
+    for (size_t i = 0; i < testNames.size(); i++) {
+        TestResult result;
+        if (!runTest(window, testMenu, testNames[i], result))
+            return 1;
+        if (!result.goldenPassed) {
+            std::cout << "Golden image check of \"" << result.testName << "\" " << result.goldenStatus << "\n";
+            passed = false;
+        }
+        if (i > 0)
+            json += ",\n";
+        json += toJSON(result);
+    }
+    json += testNames.size() > 1 ? "\n]\n" : "\n";
+
+    std::ofstream out(options.outputFile);
+    if (out.is_open())
+        out << json;
+    else
+        std::cout << "Could not open " << options.outputFile << " for benchmark output\n";
+    std::cout << json;
+    return passed ? 0 : 1;
+}
+
+bool Benchmark::runTest(GLFWwindow* window, test::TestMenu& testMenu, const std::string& testName, TestResult& result) {
+    // Tests which animate using glfwGetTime() or seed rand() with it, see same time on every run
+    glfwSetTime(0.0);
+    unsigned int programsLoaded = ProgramCache::getLoadedCount();
+    unsigned int programsCompiled = ProgramCache::getCompiledCount();
+    auto setupStart = std::chrono::steady_clock::now();
+    test::Test* test = testMenu.createTest(testName);
+    if (!test) {
+        std::cout << "No test named \"" << testName << "\", registered tests:\n";
+        for (const std::string& name : testMenu.getTestNames())
+            std::cout << "  " << name << "\n";
+        return false;
+    }
+    result.testName = testName;
+    // Loading hitches are not what is measured, and golden frame must not catch textures half uploaded
+    UploadQueue::finish();
+    // Draws with programs still compiling would be skipped
+    Shader::finishAll();
+    result.setupMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - setupStart).count();
+    result.programsLoaded = ProgramCache::getLoadedCount() - programsLoaded;
+    result.programsCompiled = ProgramCache::getCompiledCount() - programsCompiled;
+
+    Camera camera(glm::vec3(options.orbitRadius, options.orbitHeight, 0.0f));
+    test->setCamera(&camera);
+
+    unsigned int totalFrames = options.warmupFrames + options.frames;
+    std::unique_ptr<PixelReadback> readback;
+    if (!options.goldenDir.empty()) {
+        int framebufferWidth, framebufferHeight;
+        glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight);
+        readback = std::make_unique<PixelReadback>(framebufferWidth, framebufferHeight);
+        totalFrames = std::max(totalFrames, options.goldenFrame + 1);
+    }
+    Image capturedFrame;
+    unsigned int capturedTag;
+    bool captured = false;
+
+    Renderer renderer;
+    result.frameTimes.reserve(options.frames);
+
+    auto lastFrameEnd = std::chrono::steady_clock::now();
+    for (unsigned int frame = 0; frame < totalFrames && !glfwWindowShouldClose(window); frame++) {
+        float angle = frame * glm::two_pi<float>() / ORBIT_FRAMES;
+        camera.Position = glm::vec3(std::cos(angle) * options.orbitRadius, options.orbitHeight, std::sin(angle) * options.orbitRadius);
+        camera.lookAt(glm::vec3(0.0f));
+        glfwSetTime(frame * FIXED_DELTA_TIME);
+
+        GLState::newFrame();
+        VertexBuffer::newFrame();
+        DeletionQueue::newFrame();
+        GPUProfiler::beginFrame();
+        UploadQueue::flush();
+
+        GLCall(glClearColor(0.0f, 0.0f, 0.0f, 1.0f));
+        renderer.clear();
+        test->onUpdate(FIXED_DELTA_TIME);
+        test->onRender();
+        renderer.flush();
+        if (readback && frame == options.goldenFrame)
+            readback->request(frame);
+
+        GPUProfiler::endFrame();
+        glfwSwapBuffers(window);
+        glfwPollEvents();
+
+        // Only picks up finished copy, comparing is left until timing is done
+        if (readback && readback->hasPending())
+            captured = readback->poll(capturedFrame, capturedTag);
+
+        // Time between consecutive swaps, so CPU and GPU work overlapping across frames is counted once
+        auto frameEnd = std::chrono::steady_clock::now();
+        if (frame >= options.warmupFrames && result.frameTimes.size() < options.frames)
+            result.frameTimes.push_back(std::chrono::duration<float, std::milli>(frameEnd - lastFrameEnd).count());
+        lastFrameEnd = frameEnd;
+    }
+
+    if (readback && readback->hasPending())
+        captured = readback->poll(capturedFrame, capturedTag, true);
+    if (readback) {
+        if (captured) {
+            checkGolden(capturedFrame, result);
+        } else {
+            result.goldenChecked = true;
+            result.goldenPassed = false;
+            result.goldenStatus = "failed, frame was not captured";
+        }
+    }
+
+    delete test;
+    resetGLState();
+    return true;
+}
+
+void Benchmark::checkGolden(const Image& frame, TestResult& result) {
+    result.goldenChecked = true;
+    std::string path = options.goldenDir + "/" + goldenFileName(result.testName);
+
+    if (options.updateGolden) {
+        result.goldenPassed = frame.savePNG(path + ".png");
+        result.goldenStatus = result.goldenPassed ? "updated" : "failed, could not write golden";
+        return;
+    }
+
+    Image expected;
+    if (!expected.loadPNG(path + ".png")) {
+        result.goldenPassed = false;
+        result.goldenStatus = "failed, missing " + path + ".png (run with --update-golden)";
+        frame.savePNG(path + ".actual.png");
+        return;
+    }
+
+    Image diff;
+    result.comparison = Image::compare(expected, frame, options.tolerance, diff);
+    bool sameSize = expected.getWidth() == frame.getWidth() && expected.getHeight() == frame.getHeight();
+    float mismatch = static_cast<float>(result.comparison.mismatchedPixels) / (expected.getWidth() * expected.getHeight());
+    result.goldenPassed = sameSize && mismatch <= options.maxMismatch;
+    if (result.goldenPassed) {
+        result.goldenStatus = "passed";
+    } else {
+        result.goldenStatus = sameSize ? "failed, see " + path + ".diff.png" : "failed, size differs from golden";
+        frame.savePNG(path + ".actual.png");
+        diff.savePNG(path + ".diff.png");
+    }
+}
+
+std::string Benchmark::toJSON(const TestResult& result) const {
+    std::stringstream json;
+    json << "{\n"
+        << "  \"test\": \"" << escape(result.testName) << "\",\n"
+        << "  \"renderer\": \"" << escape(reinterpret_cast<const char*>(glGetString(GL_RENDERER))) << "\",\n"
+        << "  \"version\": \"" << escape(reinterpret_cast<const char*>(glGetString(GL_VERSION))) << "\",\n"
+        << "  \"width\": " << options.width << ",\n"
+        << "  \"height\": " << options.height << ",\n"
+        << "  \"frames\": " << result.frameTimes.size() << ",\n"
+        << "  \"warmup_frames\": " << options.warmupFrames << ",\n"
+        << "  \"setup_ms\": " << result.setupMs << ",\n"
+        << "  \"programs\": {\"loaded\": " << result.programsLoaded << ", \"compiled\": " << result.programsCompiled << "}";
+
+    if (!result.frameTimes.empty()) {
+        std::vector<float> sorted = result.frameTimes;
+        std::sort(sorted.begin(), sorted.end());
+        float total = 0.0f;
+        for (float time : sorted)
+            total += time;
+
+        json << ",\n  \"frame_ms\": {"
+            << "\"min\": " << sorted.front()
+            << ", \"p50\": " << percentile(sorted, 0.50f)
+            << ", \"p95\": " << percentile(sorted, 0.95f)
+            << ", \"p99\": " << percentile(sorted, 0.99f)
+            << ", \"max\": " << sorted.back()
+            << ", \"mean\": " << total / sorted.size() << "}";
+    }
+    if (result.goldenChecked) {
+        json << ",\n  \"golden\": {"
+            << "\"frame\": " << options.goldenFrame
+            << ", \"passed\": " << (result.goldenPassed ? "true" : "false")
+            << ", \"status\": \"" << escape(result.goldenStatus) << "\""
+            << ", \"mismatched_pixels\": " << result.comparison.mismatchedPixels
+            << ", \"max_difference\": " << result.comparison.maxDifference << "}";
+    }
+    json << "\n}";
+    return json.str();
+}
@@ -0,0 +1,69 @@
+#ifndef __Benchmark__
+#define __Benchmark__
+
+#include <string>
+#include <vector>
+
+#include "tests/Test.hpp"
+#include "Image.hpp"
+
+struct BenchmarkOptions {
+    bool enabled = false;
+    std::string testName; ///< Empty runs every registered test, only allowed together with golden images
+    unsigned int frames = 1000;
+    unsigned int warmupFrames = 60; ///< Not measured, lets driver finish lazy allocations and shader compiles
+    int width = 1920;
+    int height = 1080;
+    float orbitRadius = 6.0f;
+    float orbitHeight = 2.0f;
+    std::string outputFile = "benchmark.json";
+
+    // Golden image check, enabled by non empty directory
+    std::string goldenDir;
+    unsigned int goldenFrame = 100; ///< Counted from the first frame, including warmup
+    bool updateGolden = false;      ///< Store captured frames as new goldens instead of comparing
+    int tolerance = 2;              ///< Allowed per channel difference
+    float maxMismatch = 0.001f;     ///< Allowed fraction of mismatched pixels
+
+    std::string shaderCacheDir = "shader_cache"; ///< Program binary cache, also used outside benchmarks, empty disables
+};
+
+// Runs registered tests for fixed number of frames without any user input:
+// camera orbits around origin driven by frame index, update step and glfwGetTime() are fixed per frame,
+// so every run renders same frames. Meant to be started from CLI in invisible window with vsync off,
+// for example on CI using Mesa llvmpipe:
+//   OpenGLTest --bench "Instanced drawing" --frames 2000 --size 1920x1080
+// With --golden, frame goldenFrame of each test is read back asynchronously and compared against stored PNG,
+// so same run checks both that picture did not change and how long frames took:
+//   OpenGLTest --golden assets/golden --frames 300
+class Benchmark {
+    public:
+        Benchmark(const BenchmarkOptions& options);
+
+        // Returns false and prints usage on malformed arguments, options.enabled is set if --bench or --golden was given
+        static bool parseArguments(int argc, char** argv, BenchmarkOptions& options);
+
+        // Returns process exit code, non zero if test is missing or golden image check failed.
+        // Frame time percentiles and golden results are written to options.outputFile and stdout as JSON
+        int run(GLFWwindow* window, test::TestMenu& testMenu);
+    private:
+        struct TestResult {
+            std::string testName;
+            std::vector<float> frameTimes; ///< Milliseconds, measured frames only
+            float setupMs = 0.0f;          ///< Test creation until all uploads finished, cold vs warm program cache
+            unsigned int programsLoaded = 0;
+            unsigned int programsCompiled = 0;
+            bool goldenChecked = false;
+            bool goldenPassed = true;
+            std::string goldenStatus;
+            ImageComparison comparison;
+        };
+
+        BenchmarkOptions options;
+
+        bool runTest(GLFWwindow* window, test::TestMenu& testMenu, const std::string& testName, TestResult& result);
+        void checkGolden(const Image& frame, TestResult& result);
+        std::string toJSON(const TestResult& result) const;
+};
+
+#endif // __Benchmark__
@@ -0,0 +1,150 @@
+#include "CPUProfiler.hpp"
+
+#include "imgui/imgui.h"
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace {
+    struct Event {
+        const char* name;
+        long long start; ///< Nanoseconds of steady_clock
+        long long duration;
+    };
+
+    struct OpenScope {
+        const char* name;
+        long long start;
+    };
+
+    struct ThreadBuffer {
+        unsigned int threadIndex;
+        std::mutex mutex; ///< Only ever contended while capture is being written out
+        std::vector<Event> events;
+        std::vector<OpenScope> stack; ///< Touched by owning thread only
+    };
+
+    std::atomic<bool> capturing(false);
+    std::atomic<long long> captureStart(0);
+
+    // Buffers are owned here instead of by thread, so events survive threads which exit mid capture
+    std::mutex buffersMutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+
+    long long now() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    ThreadBuffer& threadBuffer() {
+        thread_local ThreadBuffer* buffer = nullptr;
+        if (!buffer) {
+            std::lock_guard<std::mutex> lock(buffersMutex);
+            buffers.push_back(std::make_unique<ThreadBuffer>());
+            buffer = buffers.back().get();
+            buffer->threadIndex = buffers.size() - 1;
+            buffer->events.reserve(1 << 16);
+        }
+        return *buffer;
+    }
+
+    void writeEscaped(std::ofstream& out, const char* text) {
+        for (const char* c = text; *c; c++) {
+            if (*c == '"' || *c == '\\')
+                out << '\\';
+            out << *c;
+        }
+    }
+}
+
+void CPUProfiler::beginCapture() {
+    std::lock_guard<std::mutex> lock(buffersMutex);
+    for (auto& buffer : buffers) {
+        std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+        buffer->events.clear();
+    }
+    captureStart = now();
+    capturing = true;
+}
+
+bool CPUProfiler::endCapture(const std::string& fileName) {
+    capturing = false;
+
+    std::ofstream out(fileName);
+    if (!out.is_open()) {
+        std::cout << "Could not open " << fileName << " for CPU profiler output\n";
+        return false;
+    }
+
+    // Chrome trace format, timestamps in microseconds, one complete ("X") event per scope
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    std::lock_guard<std::mutex> lock(buffersMutex);
+    for (auto& buffer : buffers) {
+        std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+        if (!first)
+            out << ",";
+        first = false;
+        out << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << buffer->threadIndex
+            << ",\"args\":{\"name\":\"Thread " << buffer->threadIndex << "\"}}";
+
+        for (const Event& event : buffer->events) {
+            out << ",\n{\"name\":\"";
+            writeEscaped(out, event.name);
+            out << "\",\"cat\":\"cpu\",\"ph\":\"X\",\"pid\":0,\"tid\":" << buffer->threadIndex
+                << ",\"ts\":" << (event.start - captureStart) / 1000.0
+                << ",\"dur\":" << event.duration / 1000.0 << "}";
+        }
+        buffer->events.clear();
+    }
+    out << "\n]}\n";
+
+    std::cout << "CPU profile written to " << fileName << std::endl;
+    return true;
+}
+
+bool CPUProfiler::isCapturing() {
+    return capturing;
+}
+
+void CPUProfiler::beginScope(const char* name) {
+    if (!capturing)
+        return;
+    threadBuffer().stack.push_back({name, now()});
+}
+
+void CPUProfiler::endScope() {
+    ThreadBuffer& buffer = threadBuffer();
+    // Scope was opened while capture was off
+    if (buffer.stack.empty())
+        return;
+
+    // Scopes still open when capture stopped are popped without being recorded,
+    // so stack is back in balance by the time outermost scope closes
+    OpenScope scope = buffer.stack.back();
+    buffer.stack.pop_back();
+    if (!capturing || scope.start < captureStart)
+        return;
+    long long end = now();
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    buffer.events.push_back({scope.name, scope.start, end - scope.start});
+}
+
+void CPUProfiler::onImGuiRender() {
+    ImGui::Begin("CPU Profiler");
+    if (!capturing) {
+        if (ImGui::Button("Start capture"))
+            beginCapture();
+    } else {
+        if (ImGui::Button("Stop and write cpu_trace.json"))
+            endCapture("cpu_trace.json");
+        ImGui::SameLine();
+        ImGui::Text("Capturing for %.1f s", (now() - captureStart) / 1000000000.0);
+    }
+    ImGui::End();
+}
@@ -0,0 +1,39 @@
+#ifndef __CPUProfiler__
+#define __CPUProfiler__
+
+#include <string>
+
+// Records CPU time of named scopes into per thread buffers using steady_clock and writes them
+// as Chrome trace JSON (open in chrome://tracing or ui.perfetto.dev). Outside of capture a scope
+// costs one flag check, so instrumentation can stay in release builds
+class CPUProfiler {
+    public:
+        static void beginCapture();
+        // Stops recording and writes everything captured since beginCapture(), returns false if file can't be written
+        static bool endCapture(const std::string& fileName);
+        static bool isCapturing();
+
+        // Scope name must be string literal or otherwise outlive the capture
+        static void beginScope(const char* name);
+        static void endScope();
+
+        // Panel with capture controls
+        static void onImGuiRender();
+};
+
+class CPUProfileScope {
+    public:
+        CPUProfileScope(const char* name) { CPUProfiler::beginScope(name); }
+        ~CPUProfileScope() { CPUProfiler::endScope(); }
+};
+
+#define CPU_PROFILE_CONCAT_IMPL(a, b) a##b
+#define CPU_PROFILE_CONCAT(a, b) CPU_PROFILE_CONCAT_IMPL(a, b)
+#define PROFILE_SCOPE(name) CPUProfileScope CPU_PROFILE_CONCAT(cpuProfileScope, __LINE__)(name)
+#ifdef _MSC_VER
+#define PROFILE_FUNCTION() PROFILE_SCOPE(__FUNCSIG__)
+#else
+#define PROFILE_FUNCTION() PROFILE_SCOPE(__PRETTY_FUNCTION__)
+#endif
+
+#endif // __CPUProfiler__
@@ -60,6 +60,14 @@ void Camera::processMouseScroll(float yOffset) {
         Zoom = 45.0f;
 }
 
+void Camera::lookAt(const glm::vec3& target) {
+    glm::vec3 direction = glm::normalize(target - Position);
+    // Inverse of the euler angle to front vector conversion below
+    Pitch = glm::clamp(glm::degrees(std::asin(direction.y)), -89.0f, 89.0f);
+    Yaw = glm::degrees(std::atan2(direction.z, direction.x));
+    updateCameraVectors();
+}
+
 void Camera::updateCameraVectors() {
     // Calculate new front vector using euler angles
     glm::vec3 front;
@@ -42,6 +42,9 @@ class Camera {
         void processKeyboard(CameraMovement direction, float deltaTime);
         void processMouseMovement(float xOffset, float yOffset, bool constrainPitch = true);
         void processMouseScroll(float yOffset);
+
+        // Turns camera towards target, used by scripted camera in benchmarks
+        void lookAt(const glm::vec3& target);
     private:
 
         // Using Euler Angles
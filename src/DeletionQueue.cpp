@@ -0,0 +1,178 @@
+#include "DeletionQueue.hpp"
+#include "GLHandle.hpp"
+
+#include "Renderer.hpp"
+#include "GLState.hpp"
+
+#include <algorithm>
+#include <deque>
+#include <vector>
+
+namespace {
+    const unsigned int TYPE_COUNT = static_cast<unsigned int>(GLObjectType::COUNT);
+
+    struct Batch {
+        GLsync fence = nullptr;
+        std::vector<unsigned int> objects[TYPE_COUNT];
+    };
+
+    struct State {
+        Batch current; ///< Objects released this frame, not fenced yet
+        std::deque<Batch> fenced;
+        unsigned int pendingCount = 0;
+        unsigned int lastDeletedCount = 0;
+    };
+
+    State& state() {
+        static State s;
+        return s;
+    }
+
+    // Deletes up to limit objects of the batch, returns how many were deleted
+    unsigned int deleteObjects(Batch& batch, unsigned int limit) {
+        unsigned int deleted = 0;
+        for (unsigned int type = 0; type < TYPE_COUNT && deleted < limit; type++) {
+            std::vector<unsigned int>& objects = batch.objects[type];
+            if (objects.empty())
+                continue;
+            unsigned int count = std::min<unsigned int>(objects.size(), limit - deleted);
+            // Deleted from the back, so a partially deleted batch just keeps its front
+            const unsigned int* ids = &objects[objects.size() - count];
+
+            for (unsigned int i = 0; i < count; i++) {
+                // GL unbinds deleted objects by itself, so cache must forget them too
+                switch (static_cast<GLObjectType>(type)) {
+                    case GLObjectType::BUFFER:       GLState::onBufferDeleted(ids[i]); break;
+                    case GLObjectType::TEXTURE:      GLState::onTextureDeleted(ids[i]); break;
+                    case GLObjectType::VERTEX_ARRAY: GLState::onVertexArrayDeleted(ids[i]); break;
+                    case GLObjectType::PROGRAM:      GLState::onProgramDeleted(ids[i]); break;
+                    case GLObjectType::PROGRAM_PIPELINE: GLState::onProgramPipelineDeleted(ids[i]); break;
+                    default: break;
+                }
+            }
+            switch (static_cast<GLObjectType>(type)) {
+                case GLObjectType::BUFFER:
+                    GLCall(glDeleteBuffers(count, ids));
+                    break;
+                case GLObjectType::TEXTURE:
+                    GLCall(glDeleteTextures(count, ids));
+                    break;
+                case GLObjectType::VERTEX_ARRAY:
+                    GLCall(glDeleteVertexArrays(count, ids));
+                    break;
+                case GLObjectType::PROGRAM:
+                    // No batched version for programs
+                    for (unsigned int i = 0; i < count; i++) {
+                        GLCall(glDeleteProgram(ids[i]));
+                    }
+                    break;
+                case GLObjectType::PROGRAM_PIPELINE:
+                    GLCall(glDeleteProgramPipelines(count, ids));
+                    break;
+                default:
+                    break;
+            }
+            objects.resize(objects.size() - count);
+            deleted += count;
+        }
+        return deleted;
+    }
+
+    bool isEmpty(const Batch& batch) {
+        for (unsigned int type = 0; type < TYPE_COUNT; type++) {
+            if (!batch.objects[type].empty())
+                return false;
+        }
+        return true;
+    }
+}
+
+void DeletionQueue::push(GLObjectType type, unsigned int id) {
+    State& s = state();
+    s.current.objects[static_cast<unsigned int>(type)].push_back(id);
+    s.pendingCount++;
+}
+
+void DeletionQueue::newFrame() {
+    State& s = state();
+    if (!isEmpty(s.current)) {
+        GLCall(s.current.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+        s.fenced.push_back(std::move(s.current));
+        s.current = Batch();
+    }
+
+    unsigned int deleted = 0;
+    while (!s.fenced.empty() && deleted < MAX_DELETES_PER_FRAME) {
+        Batch& batch = s.fenced.front();
+        if (batch.fence) {
+            // Polled without waiting, batch simply stays for another frame
+            GLCall(GLenum status = glClientWaitSync(batch.fence, 0, 0));
+            if (status == GL_TIMEOUT_EXPIRED)
+                break;
+            GLCall(glDeleteSync(batch.fence));
+            batch.fence = nullptr;
+        }
+        deleted += deleteObjects(batch, MAX_DELETES_PER_FRAME - deleted);
+        if (!isEmpty(batch))
+            break;
+        s.fenced.pop_front();
+    }
+    s.pendingCount -= deleted;
+    s.lastDeletedCount = deleted;
+}
+
+void DeletionQueue::shutdown() {
+    State& s = state();
+    s.fenced.push_back(std::move(s.current));
+    s.current = Batch();
+    for (Batch& batch : s.fenced) {
+        if (batch.fence) {
+            GLCall(glDeleteSync(batch.fence));
+        }
+        deleteObjects(batch, 0xFFFFFFFF);
+    }
+    s.fenced.clear();
+    s.pendingCount = 0;
+}
+
+unsigned int DeletionQueue::getPendingCount() {
+    return state().pendingCount;
+}
+
+unsigned int DeletionQueue::getDeletedCount() {
+    return state().lastDeletedCount;
+}
+
+template <>
+BufferHandle BufferHandle::create() {
+    unsigned int id = 0;
+    GLCall(glGenBuffers(1, &id));
+    return BufferHandle(id);
+}
+
+template <>
+TextureHandle TextureHandle::create() {
+    unsigned int id = 0;
+    GLCall(glGenTextures(1, &id));
+    return TextureHandle(id);
+}
+
+template <>
+VertexArrayHandle VertexArrayHandle::create() {
+    unsigned int id = 0;
+    GLCall(glGenVertexArrays(1, &id));
+    return VertexArrayHandle(id);
+}
+
+template <>
+ProgramHandle ProgramHandle::create() {
+    GLCall(unsigned int id = glCreateProgram());
+    return ProgramHandle(id);
+}
+
+template <>
+ProgramPipelineHandle ProgramPipelineHandle::create() {
+    unsigned int id = 0;
+    GLCall(glGenProgramPipelines(1, &id));
+    return ProgramPipelineHandle(id);
+}
@@ -0,0 +1,34 @@
+#ifndef __DeletionQueue__
+#define __DeletionQueue__
+
+enum class GLObjectType {
+    BUFFER,
+    TEXTURE,
+    VERTEX_ARRAY,
+    PROGRAM,
+    PROGRAM_PIPELINE,
+    COUNT
+};
+
+// Collects GL objects released by GLHandle during a frame. newFrame() puts fence after everything issued
+// so far for those objects, and batches whose fence already signalled are deleted with one glDelete* call
+// per object type. Destroying whole test therefore costs nothing mid frame and never waits for the GPU.
+// Up to MAX_DELETES_PER_FRAME objects are deleted per frame, rest waits for next frames
+class DeletionQueue {
+    public:
+        static const unsigned int MAX_DELETES_PER_FRAME = 4096;
+
+        static void push(GLObjectType type, unsigned int id);
+
+        // Called once per frame
+        static void newFrame();
+        // Deletes everything immediately, must be called before context is destroyed
+        static void shutdown();
+
+        // Objects waiting for their fence
+        static unsigned int getPendingCount();
+        // Objects deleted by last newFrame()
+        static unsigned int getDeletedCount();
+};
+
+#endif // __DeletionQueue__
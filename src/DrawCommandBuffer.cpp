@@ -0,0 +1,38 @@
+#include "DrawCommandBuffer.hpp"
+
+#include "Renderer.hpp"
+#include "GLState.hpp"
+
+DrawCommandBuffer::DrawCommandBuffer()
+    : rendererID(BufferHandle::create()), capacity(0), dirty(false) {
+}
+
+unsigned int DrawCommandBuffer::addCommand(unsigned int count, unsigned int firstIndex, int baseVertex,
+        unsigned int instanceCount, unsigned int baseInstance) {
+    commands.push_back({count, instanceCount, firstIndex, baseVertex, baseInstance});
+    dirty = true;
+    return commands.size() - 1;
+}
+
+void DrawCommandBuffer::clear() {
+    commands.clear();
+    dirty = true;
+}
+
+void DrawCommandBuffer::upload() {
+    if (!dirty)
+        return;
+    bind();
+    unsigned int size = commands.size() * sizeof(DrawElementsIndirectCommand);
+    if (commands.size() > capacity) {
+        capacity = commands.size();
+        GLCall(glBufferData(GL_DRAW_INDIRECT_BUFFER, size, commands.data(), GL_DYNAMIC_DRAW));
+    } else {
+        GLCall(glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, size, commands.data()));
+    }
+    dirty = false;
+}
+
+void DrawCommandBuffer::bind() const {
+    GLState::bindBuffer(GL_DRAW_INDIRECT_BUFFER, rendererID.get());
+}
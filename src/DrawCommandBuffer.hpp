@@ -0,0 +1,45 @@
+#ifndef __DrawCommandBuffer__
+#define __DrawCommandBuffer__
+
+#include <GL/glew.h>
+#include <vector>
+
+#include "GLHandle.hpp"
+
+// Layout is defined by GL spec, must not be changed
+struct DrawElementsIndirectCommand {
+    GLuint count;
+    GLuint instanceCount;
+    GLuint firstIndex;
+    GLint baseVertex;
+    GLuint baseInstance;
+};
+
+// Builds list of indirect draw commands and keeps it in GL_DRAW_INDIRECT_BUFFER,
+// so whole list can be issued with single glMultiDrawElementsIndirect call
+class DrawCommandBuffer {
+    public:
+        DrawCommandBuffer();
+
+        DrawCommandBuffer(const DrawCommandBuffer&) = delete;
+        DrawCommandBuffer& operator=(const DrawCommandBuffer&) = delete;
+
+        // Returns index of added command, base instance is usually used to fetch per draw data
+        unsigned int addCommand(unsigned int count, unsigned int firstIndex, int baseVertex,
+                unsigned int instanceCount = 1, unsigned int baseInstance = 0);
+        void clear();
+
+        // Uploads commands if they changed since last upload
+        void upload();
+        void bind() const;
+
+        inline unsigned int getCommandCount() const { return commands.size(); }
+        inline const std::vector<DrawElementsIndirectCommand>& getCommands() const { return commands; }
+    private:
+        BufferHandle rendererID;
+        unsigned int capacity; ///< Size of GL buffer in commands
+        bool dirty;
+        std::vector<DrawElementsIndirectCommand> commands;
+};
+
+#endif // __DrawCommandBuffer__
@@ -0,0 +1,61 @@
+#include "FrameUniforms.hpp"
+
+#include "Renderer.hpp"
+#include "GLState.hpp"
+#include "GLHandle.hpp"
+
+#include <iostream>
+
+namespace {
+    struct State {
+        BufferHandle frameBuffer;
+        BufferHandle lightBuffer;
+    };
+
+    State& state() {
+        static State s;
+        return s;
+    }
+
+    void upload(BufferHandle& buffer, unsigned int binding, const void* data, unsigned int size) {
+        if (!buffer)
+            buffer = BufferHandle::create();
+        GLState::bindBuffer(GL_UNIFORM_BUFFER, buffer.get());
+        // Orphaning, so draws of last frame still reading old contents don't stall the update
+        GLCall(glBufferData(GL_UNIFORM_BUFFER, size, data, GL_STREAM_DRAW));
+        // Same buffer name stays bound, so this is issued only once
+        GLState::bindBufferBase(GL_UNIFORM_BUFFER, binding, buffer.get());
+    }
+
+    void bindBlock(unsigned int program, const ShaderUniformBlock& block, unsigned int binding, unsigned int size) {
+        // Drivers may or may not count padding after last member, so block can be smaller than the struct
+        if (block.dataSize > size) {
+            std::cout << "Uniform block " << block.name << " is " << block.dataSize << " bytes, struct only " << size << "\n";
+        }
+        GLCall(glUniformBlockBinding(program, block.index, binding));
+    }
+}
+
+void FrameUniforms::setFrame(const glm::mat4& projection, const glm::mat4& view, const glm::vec3& viewPosition) {
+    FrameConstants frame = {projection, view, viewPosition, 0.0f};
+    upload(state().frameBuffer, FRAME_BINDING, &frame, sizeof(frame));
+}
+
+void FrameUniforms::setLights(const LightConstants& lights) {
+    upload(state().lightBuffer, LIGHT_BINDING, &lights, sizeof(lights));
+}
+
+void FrameUniforms::bindBlocks(unsigned int program, const std::vector<ShaderUniformBlock>& blocks) {
+    for (const ShaderUniformBlock& block : blocks) {
+        if (block.name == "FrameConstants")
+            bindBlock(program, block, FRAME_BINDING, sizeof(FrameConstants));
+        else if (block.name == "LightConstants")
+            bindBlock(program, block, LIGHT_BINDING, sizeof(LightConstants));
+    }
+}
+
+void FrameUniforms::shutdown() {
+    State& s = state();
+    s.frameBuffer.reset();
+    s.lightBuffer.reset();
+}
@@ -0,0 +1,95 @@
+#ifndef __FrameUniforms__
+#define __FrameUniforms__
+
+#include <GL/glew.h>
+
+#include <vector>
+
+#include "glm/glm.hpp"
+
+struct ShaderUniformBlock;
+
+// std140 layouts, must match uniform blocks of the same name in shaders (e.g. lightCasters.glsl),
+// every vec3 takes 16 bytes unless a float follows it
+
+struct FrameConstants {
+    glm::mat4 projection;
+    glm::mat4 view;
+    glm::vec3 viewPosition;
+    float padding;
+};
+
+struct DirectionalLightConstants {
+    glm::vec3 direction;
+    float padding0;
+    glm::vec3 ambient;
+    float padding1;
+    glm::vec3 diffuse;
+    float padding2;
+    glm::vec3 specular;
+    float padding3;
+};
+
+struct PointLightConstants {
+    glm::vec3 position;
+    float padding0;
+    glm::vec3 ambient;
+    float padding1;
+    glm::vec3 diffuse;
+    float padding2;
+    glm::vec3 specular;
+    // Attenuation
+    float constant;
+    float linear;
+    float quadratic;
+    float padding3[2];
+};
+
+struct SpotLightConstants {
+    glm::vec3 position;
+    float padding0;
+    glm::vec3 direction;
+    float cutOff;      ///< Cosine of inner cone angle
+    float outerCutOff; ///< Cosine of outer cone angle
+    float padding1[3];
+    glm::vec3 ambient;
+    float padding2;
+    glm::vec3 diffuse;
+    float padding3;
+    glm::vec3 specular;
+    float padding4;
+};
+
+struct LightConstants {
+    DirectionalLightConstants dirLight;
+    PointLightConstants pointLight;
+    SpotLightConstants spotLight;
+};
+
+static_assert(sizeof(FrameConstants) == 144, "FrameConstants must match std140 layout");
+static_assert(sizeof(PointLightConstants) == 80, "PointLightConstants must match std140 layout");
+static_assert(sizeof(SpotLightConstants) == 96, "SpotLightConstants must match std140 layout");
+static_assert(sizeof(LightConstants) == 240, "LightConstants must match std140 layout");
+
+// Camera and light constants shared by all shaders, uploaded once per frame into uniform buffers
+// bound to fixed binding points, instead of 25 or so glUniform calls per shader and frame.
+// GLSL 330 has no binding qualifier, so Shader assigns blocks to binding points after linking
+class FrameUniforms {
+    public:
+        enum Binding : unsigned int {
+            FRAME_BINDING = 0,
+            LIGHT_BINDING = 1
+        };
+
+        static void setFrame(const glm::mat4& projection, const glm::mat4& view, const glm::vec3& viewPosition);
+        static void setLights(const LightConstants& lights);
+
+        // Assigns FrameConstants and LightConstants blocks of program (if it uses them) to their binding points,
+        // blocks are reflected from the program, so their size is checked against the C++ structs
+        static void bindBlocks(unsigned int program, const std::vector<ShaderUniformBlock>& blocks);
+
+        // Buffers must be released while context exists
+        static void shutdown();
+};
+
+#endif // __FrameUniforms__
@@ -0,0 +1,152 @@
+#include "GLDebug.hpp"
+
+#include "Renderer.hpp"
+
+#include <atomic>
+#include <iostream>
+
+namespace {
+    struct CallSite {
+        const char* func = nullptr;
+        const char* file = nullptr;
+        int line = 0;
+    };
+
+    GLDebugMode mode = GLDebugMode::GET_ERROR;
+    bool debugOutputInstalled = false;
+    bool synchronousOutput = false;
+    // Asynchronous output may call back from driver thread
+    std::atomic<bool> errorReported(false);
+    CallSite currentCall;
+    unsigned long long callCount = 0;
+
+    const char* sourceToString(GLenum source) {
+        switch (source) {
+            case GL_DEBUG_SOURCE_API:               return "API";
+            case GL_DEBUG_SOURCE_WINDOW_SYSTEM:     return "Window System";
+            case GL_DEBUG_SOURCE_SHADER_COMPILER:   return "Shader Compiler";
+            case GL_DEBUG_SOURCE_THIRD_PARTY:       return "Third Party";
+            case GL_DEBUG_SOURCE_APPLICATION:       return "Application";
+        }
+        return "Other";
+    }
+
+    const char* typeToString(GLenum type) {
+        switch (type) {
+            case GL_DEBUG_TYPE_ERROR:               return "Error";
+            case GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR: return "Deprecated";
+            case GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR:  return "Undefined Behaviour";
+            case GL_DEBUG_TYPE_PORTABILITY:         return "Portability";
+            case GL_DEBUG_TYPE_PERFORMANCE:         return "Performance";
+        }
+        return "Other";
+    }
+
+    void GLAPIENTRY debugCallback(GLenum source, GLenum type, GLuint id, GLenum severity,
+            GLsizei length, const GLchar* message, const void* userParam) {
+        // Notifications are mostly buffer placement info, way too noisy
+        if (severity == GL_DEBUG_SEVERITY_NOTIFICATION)
+            return;
+
+        std::cout << "[OpenGL " << typeToString(type) << "] (" << sourceToString(source) << ", " << id << "): " << message;
+        // Only synchronous message is known to come from the call in progress, outside of GLCall there is none
+        if (synchronousOutput && currentCall.func)
+            std::cout << " " << currentCall.func << " " << currentCall.file << ":" << currentCall.line;
+        std::cout << "\n";
+
+        if (synchronousOutput && type == GL_DEBUG_TYPE_ERROR)
+            errorReported = true;
+    }
+}
+
+void GLClearError() {
+    while(glGetError() != GL_NO_ERROR);
+}
+
+bool GLLogCall(const char* func, const char* file, int line) {
+    while(GLenum error = glGetError()) {
+        std::cout << "[OpenGL Error] " << "(" << error << "): " << func << " " << file << ":" << line << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void GLDebug::init(bool synchronous) {
+#ifdef DEBUG
+    // Core since 4.3, context flag tells if we actually got debug context
+    if (GLEW_KHR_debug || GLEW_VERSION_4_3) {
+        glEnable(GL_DEBUG_OUTPUT);
+        if (synchronous)
+            glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+        else
+            glDisable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+        glDebugMessageCallback(debugCallback, nullptr);
+        glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DONT_CARE, 0, nullptr, GL_TRUE);
+        debugOutputInstalled = true;
+        synchronousOutput = synchronous;
+        mode = GLDebugMode::DEBUG_OUTPUT;
+        std::cout << "GL debug output enabled (" << (synchronous ? "synchronous" : "asynchronous") << ")\n";
+    } else {
+        mode = GLDebugMode::GET_ERROR;
+        std::cout << "KHR_debug not supported, falling back to glGetError\n";
+    }
+#else
+    mode = GLDebugMode::BARE;
+    GLint flags = 0;
+    glGetIntegerv(GL_CONTEXT_FLAGS, &flags);
+    if (flags & GL_CONTEXT_FLAG_NO_ERROR_BIT_KHR)
+        std::cout << "Running with KHR_no_error context\n";
+#endif
+}
+
+void GLDebug::setMode(GLDebugMode newMode) {
+    if (newMode == GLDebugMode::DEBUG_OUTPUT && !debugOutputInstalled)
+        return;
+    if (debugOutputInstalled) {
+        if (newMode == GLDebugMode::DEBUG_OUTPUT)
+            glEnable(GL_DEBUG_OUTPUT);
+        else
+            glDisable(GL_DEBUG_OUTPUT);
+    }
+    mode = newMode;
+}
+
+GLDebugMode GLDebug::getMode() {
+    return mode;
+}
+
+bool GLDebug::hasDebugOutput() {
+    return debugOutputInstalled;
+}
+
+void GLDebug::beginCall(const char* func, const char* file, int line) {
+    callCount++;
+    currentCall.func = func;
+    currentCall.file = file;
+    currentCall.line = line;
+    // Errors of unwrapped calls made since last GLCall must not fail this one
+    errorReported = false;
+    if (mode == GLDebugMode::GET_ERROR)
+        GLClearError();
+}
+
+bool GLDebug::endCall() {
+    bool succeeded = true;
+    switch (mode) {
+        case GLDebugMode::GET_ERROR:
+            succeeded = GLLogCall(currentCall.func, currentCall.file, currentCall.line);
+            break;
+        case GLDebugMode::DEBUG_OUTPUT:
+            // Only ever set with synchronous output, asynchronous errors are just printed
+            succeeded = !errorReported.exchange(false);
+            break;
+        default:
+            break;
+    }
+    currentCall = CallSite();
+    return succeeded;
+}
+
+unsigned long long GLDebug::getCallCount() {
+    return callCount;
+}
@@ -0,0 +1,33 @@
+#ifndef __GLDebug__
+#define __GLDebug__
+
+// How GLCall reports errors, only matters in DEBUG builds, in release builds GLCall is just the bare call
+enum class GLDebugMode {
+    BARE = 0,           ///< No error checking at all, same as release build
+    GET_ERROR = 1,      ///< glGetError before and after every call, forces round trips to the driver
+    DEBUG_OUTPUT = 2    ///< KHR_debug callback, driver reports errors itself
+};
+
+// Error reporting built on glDebugMessageCallback. GLCall records its call site before the call,
+// so with synchronous debug output every message can be attributed to file and line
+class GLDebug {
+    public:
+        // Must be called after context creation and glewInit. Installs debug callback if KHR_debug is
+        // available, otherwise falls back to glGetError. Asynchronous output is cheaper, but then messages
+        // are printed without call site and don't fail GLCall
+        static void init(bool synchronous = true);
+
+        static void setMode(GLDebugMode mode);
+        static GLDebugMode getMode();
+        // True if debug callback got installed, so DEBUG_OUTPUT mode is usable
+        static bool hasDebugOutput();
+
+        // Used by GLCall macro
+        static void beginCall(const char* func, const char* file, int line);
+        static bool endCall();
+
+        // Number of GLCalls made so far, used to measure per call overhead
+        static unsigned long long getCallCount();
+};
+
+#endif // __GLDebug__
@@ -0,0 +1,59 @@
+#ifndef __GLHandle__
+#define __GLHandle__
+
+#include "DeletionQueue.hpp"
+
+// Move only owner of GL object name. Object is not deleted when handle goes away, it is handed
+// to DeletionQueue, which deletes it in batch once GPU finished commands which could still use it
+template <GLObjectType Type>
+class GLHandle {
+    public:
+        GLHandle() : id(0) {}
+        explicit GLHandle(unsigned int id) : id(id) {}
+        ~GLHandle() { reset(); }
+
+        GLHandle(GLHandle&& other) : id(other.release()) {}
+        GLHandle& operator=(GLHandle&& other) {
+            if (this != &other)
+                reset(other.release());
+            return *this;
+        }
+
+        GLHandle(const GLHandle&) = delete;
+        GLHandle& operator=(const GLHandle&) = delete;
+
+        // Generates new object of handle's type
+        static GLHandle create();
+
+        inline unsigned int get() const { return id; }
+        explicit operator bool() const { return id != 0; }
+
+        // Gives up ownership without deleting
+        unsigned int release() {
+            unsigned int released = id;
+            id = 0;
+            return released;
+        }
+
+        void reset(unsigned int newID = 0) {
+            if (id)
+                DeletionQueue::push(Type, id);
+            id = newID;
+        }
+    private:
+        unsigned int id;
+};
+
+using BufferHandle = GLHandle<GLObjectType::BUFFER>;
+using TextureHandle = GLHandle<GLObjectType::TEXTURE>;
+using VertexArrayHandle = GLHandle<GLObjectType::VERTEX_ARRAY>;
+using ProgramHandle = GLHandle<GLObjectType::PROGRAM>;
+using ProgramPipelineHandle = GLHandle<GLObjectType::PROGRAM_PIPELINE>;
+
+template <> BufferHandle BufferHandle::create();
+template <> TextureHandle TextureHandle::create();
+template <> VertexArrayHandle VertexArrayHandle::create();
+template <> ProgramHandle ProgramHandle::create();
+template <> ProgramPipelineHandle ProgramPipelineHandle::create();
+
+#endif // __GLHandle__
@@ -0,0 +1,249 @@
+#include "GLState.hpp"
+
+#include "Renderer.hpp"
+
+#include <cstdint>
+#include <unordered_map>
+
+namespace {
+    const unsigned int UNKNOWN = 0xFFFFFFFF;
+    const unsigned int MAX_TEXTURE_SLOTS = 32;
+
+    // Texture targets used by the wrappers, other targets are not cached
+    enum TextureTarget {
+        TEXTURE_2D = 0,
+        TEXTURE_CUBE_MAP = 1,
+        TEXTURE_TARGET_COUNT = 2
+    };
+
+    struct State {
+        unsigned int program = UNKNOWN;
+        unsigned int pipeline = UNKNOWN;
+        unsigned int vao = UNKNOWN;
+        unsigned int activeSlot = UNKNOWN;
+        unsigned int restartType = UNKNOWN; ///< GL_NONE while disabled
+        unsigned int textures[MAX_TEXTURE_SLOTS][TEXTURE_TARGET_COUNT];
+        // Element array buffer binding is part of VAO state, so it is tracked per VAO
+        std::unordered_map<unsigned int, unsigned int> elementBuffers;
+        std::unordered_map<GLenum, unsigned int> buffers;
+        // Keyed by target in upper and binding index in lower 32 bits
+        std::unordered_map<uint64_t, unsigned int> indexedBuffers;
+
+        unsigned int bindsIssued = 0;
+        unsigned int bindsSkipped = 0;
+        unsigned int lastBindsIssued = 0;
+        unsigned int lastBindsSkipped = 0;
+
+        State() {
+            clearTextures();
+        }
+
+        void clearTextures() {
+            for (unsigned int i = 0; i < MAX_TEXTURE_SLOTS; i++) {
+                textures[i][TEXTURE_2D] = UNKNOWN;
+                textures[i][TEXTURE_CUBE_MAP] = UNKNOWN;
+            }
+        }
+    };
+
+    State& state() {
+        static State s;
+        return s;
+    }
+
+    int textureTargetIndex(GLenum target) {
+        switch (target) {
+            case GL_TEXTURE_2D:         return TEXTURE_2D;
+            case GL_TEXTURE_CUBE_MAP:   return TEXTURE_CUBE_MAP;
+        }
+        return -1;
+    }
+
+    // Returns true if bind needs to be issued and updates cached value
+    bool changeBinding(unsigned int& cached, unsigned int value) {
+        State& s = state();
+        if (cached == value) {
+            s.bindsSkipped++;
+            return false;
+        }
+        cached = value;
+        s.bindsIssued++;
+        return true;
+    }
+}
+
+void GLState::useProgram(unsigned int program) {
+    if (changeBinding(state().program, program)) {
+        GLCall(glUseProgram(program));
+    }
+}
+
+void GLState::bindProgramPipeline(unsigned int pipeline) {
+    useProgram(0);
+    if (changeBinding(state().pipeline, pipeline)) {
+        GLCall(glBindProgramPipeline(pipeline));
+    }
+}
+
+void GLState::bindVertexArray(unsigned int vao) {
+    if (changeBinding(state().vao, vao)) {
+        GLCall(glBindVertexArray(vao));
+    }
+}
+
+void GLState::bindBuffer(GLenum target, unsigned int buffer) {
+    State& s = state();
+    if (target == GL_ELEMENT_ARRAY_BUFFER) {
+        // Without knowing which VAO is bound, there is nothing to compare against
+        if (s.vao == UNKNOWN) {
+            s.bindsIssued++;
+            GLCall(glBindBuffer(target, buffer));
+            return;
+        }
+        auto it = s.elementBuffers.find(s.vao);
+        if (it == s.elementBuffers.end())
+            it = s.elementBuffers.insert({s.vao, UNKNOWN}).first;
+        if (changeBinding(it->second, buffer)) {
+            GLCall(glBindBuffer(target, buffer));
+        }
+        return;
+    }
+
+    auto it = s.buffers.find(target);
+    if (it == s.buffers.end())
+        it = s.buffers.insert({target, UNKNOWN}).first;
+    if (changeBinding(it->second, buffer)) {
+        GLCall(glBindBuffer(target, buffer));
+    }
+}
+
+void GLState::bindBufferBase(GLenum target, unsigned int index, unsigned int buffer) {
+    State& s = state();
+    uint64_t key = (static_cast<uint64_t>(target) << 32) | index;
+    auto it = s.indexedBuffers.find(key);
+    if (it == s.indexedBuffers.end())
+        it = s.indexedBuffers.insert({key, UNKNOWN}).first;
+    if (changeBinding(it->second, buffer)) {
+        GLCall(glBindBufferBase(target, index, buffer));
+        s.buffers[target] = buffer;
+    }
+}
+
+void GLState::bindTexture(unsigned int slot, GLenum target, unsigned int texture) {
+    State& s = state();
+    if (s.activeSlot != slot) {
+        GLCall(glActiveTexture(GL_TEXTURE0 + slot));
+        s.activeSlot = slot;
+    }
+
+    int targetIndex = textureTargetIndex(target);
+    if (slot >= MAX_TEXTURE_SLOTS || targetIndex < 0) {
+        s.bindsIssued++;
+        GLCall(glBindTexture(target, texture));
+        return;
+    }
+    if (changeBinding(s.textures[slot][targetIndex], texture)) {
+        GLCall(glBindTexture(target, texture));
+    }
+}
+
+void GLState::bindTexture(GLenum target, unsigned int texture) {
+    State& s = state();
+    if (s.activeSlot == UNKNOWN) {
+        s.bindsIssued++;
+        GLCall(glBindTexture(target, texture));
+        // Can't tell which slot got changed, so forget all of them
+        s.clearTextures();
+        return;
+    }
+    bindTexture(s.activeSlot, target, texture);
+}
+
+void GLState::setPrimitiveRestart(GLenum indexType) {
+    State& s = state();
+    if (s.restartType == indexType)
+        return;
+    if (indexType == GL_NONE) {
+        GLCall(glDisable(GL_PRIMITIVE_RESTART));
+    } else {
+        if (s.restartType == GL_NONE || s.restartType == UNKNOWN) {
+            GLCall(glEnable(GL_PRIMITIVE_RESTART));
+        }
+        GLCall(glPrimitiveRestartIndex(IndexBuffer::getRestartIndex(indexType)));
+    }
+    s.restartType = indexType;
+}
+
+void GLState::onProgramDeleted(unsigned int program) {
+    State& s = state();
+    if (s.program == program)
+        s.program = UNKNOWN;
+}
+
+void GLState::onProgramPipelineDeleted(unsigned int pipeline) {
+    State& s = state();
+    if (s.pipeline == pipeline)
+        s.pipeline = 0;
+}
+
+void GLState::onVertexArrayDeleted(unsigned int vao) {
+    State& s = state();
+    s.elementBuffers.erase(vao);
+    if (s.vao == vao)
+        s.vao = 0;
+}
+
+void GLState::onBufferDeleted(unsigned int buffer) {
+    State& s = state();
+    for (auto& binding : s.buffers) {
+        if (binding.second == buffer)
+            binding.second = 0;
+    }
+    for (auto& binding : s.elementBuffers) {
+        if (binding.second == buffer)
+            binding.second = UNKNOWN;
+    }
+    for (auto& binding : s.indexedBuffers) {
+        if (binding.second == buffer)
+            binding.second = 0;
+    }
+}
+
+void GLState::onTextureDeleted(unsigned int texture) {
+    State& s = state();
+    for (unsigned int i = 0; i < MAX_TEXTURE_SLOTS; i++) {
+        for (unsigned int j = 0; j < TEXTURE_TARGET_COUNT; j++) {
+            if (s.textures[i][j] == texture)
+                s.textures[i][j] = 0;
+        }
+    }
+}
+
+void GLState::invalidate() {
+    State& s = state();
+    s.program = UNKNOWN;
+    s.pipeline = UNKNOWN;
+    s.vao = UNKNOWN;
+    s.activeSlot = UNKNOWN;
+    s.restartType = UNKNOWN;
+    s.clearTextures();
+    s.elementBuffers.clear();
+    s.buffers.clear();
+    s.indexedBuffers.clear();
+}
+
+void GLState::newFrame() {
+    State& s = state();
+    s.lastBindsIssued = s.bindsIssued;
+    s.lastBindsSkipped = s.bindsSkipped;
+    s.bindsIssued = 0;
+    s.bindsSkipped = 0;
+}
+
+unsigned int GLState::getBindsIssued() {
+    return state().lastBindsIssued;
+}
+
+unsigned int GLState::getBindsSkipped() {
+    return state().lastBindsSkipped;
+}
@@ -0,0 +1,42 @@
+#ifndef __GLState__
+#define __GLState__
+
+#include <GL/glew.h>
+
+// Central cache of currently bound GL objects. All wrappers (Shader, VertexArray, VertexBuffer,
+// IndexBuffer, Texture) bind through here, so binds which would not change anything never reach the driver.
+// Code which calls glBind* directly must call invalidate() afterwards, otherwise cache goes out of sync
+class GLState {
+    public:
+        static void useProgram(unsigned int program);
+        // Pipeline is only used while no program is, so this also unbinds current program
+        static void bindProgramPipeline(unsigned int pipeline);
+        static void bindVertexArray(unsigned int vao);
+        static void bindBuffer(GLenum target, unsigned int buffer);
+        // Binds whole buffer to indexed binding point (e.g. GL_UNIFORM_BUFFER), which also binds it to target
+        static void bindBufferBase(GLenum target, unsigned int index, unsigned int buffer);
+        // Binds texture to given slot, also makes that slot active
+        static void bindTexture(unsigned int slot, GLenum target, unsigned int texture);
+        // Binds texture to currently active slot
+        static void bindTexture(GLenum target, unsigned int texture);
+        // Enables primitive restart with largest value of given index type, GL_NONE disables it
+        static void setPrimitiveRestart(GLenum indexType);
+
+        // GL unbinds deleted objects by itself, so cache must forget them too
+        static void onProgramDeleted(unsigned int program);
+        static void onProgramPipelineDeleted(unsigned int pipeline);
+        static void onVertexArrayDeleted(unsigned int vao);
+        static void onBufferDeleted(unsigned int buffer);
+        static void onTextureDeleted(unsigned int texture);
+
+        // Forget all cached bindings, next bind of every kind will be issued
+        static void invalidate();
+
+        // Called once per frame, stores counters of the finished frame and resets them
+        static void newFrame();
+        // Counters of the last finished frame
+        static unsigned int getBindsIssued();
+        static unsigned int getBindsSkipped();
+};
+
+#endif // __GLState__
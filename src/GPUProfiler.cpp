@@ -0,0 +1,230 @@
+#include "GPUProfiler.hpp"
+
+#include "Renderer.hpp"
+#include "imgui/imgui.h"
+
+#include <vector>
+#include <fstream>
+#include <iostream>
+
+namespace {
+    // Frames in flight before results are read, big enough for drivers which queue up to 3 frames
+    const unsigned int FRAME_LATENCY = 4;
+    // Scopes not seen for this many resolved frames are hidden from the panel
+    const unsigned int STALE_FRAMES = 120;
+
+    struct ScopeRecord {
+        const char* name;
+        unsigned int depth;
+        unsigned int startQuery;
+        unsigned int endQuery;
+    };
+
+    struct FrameQueries {
+        std::vector<GLuint> queries; ///< Query objects are reused, ring slot only grows
+        unsigned int usedQueries = 0;
+        std::vector<ScopeRecord> scopes;
+        unsigned long long frameNumber = 0;
+        bool pending = false;
+    };
+
+    struct ScopeStats {
+        std::string name;
+        unsigned int depth;
+        float lastMs;
+        float averageMs;
+        float maxMs;
+        unsigned long long lastFrame;
+    };
+
+    struct Profiler {
+        FrameQueries frames[FRAME_LATENCY];
+        unsigned int currentFrame = 0;
+        unsigned long long frameNumber = 0;
+        unsigned long long lastResolvedFrame = 0;
+        unsigned int droppedFrames = 0;
+        bool enabled = true;
+        bool inFrame = false;
+        std::vector<unsigned int> scopeStack;
+        std::vector<ScopeStats> stats;
+        std::ofstream csv;
+    };
+
+    Profiler& profiler() {
+        static Profiler p;
+        return p;
+    }
+
+    unsigned int acquireQuery(FrameQueries& frame) {
+        if (frame.usedQueries == frame.queries.size()) {
+            GLuint query;
+            GLCall(glGenQueries(1, &query));
+            frame.queries.push_back(query);
+        }
+        return frame.usedQueries++;
+    }
+
+    ScopeStats& findStats(const char* name, unsigned int depth) {
+        Profiler& p = profiler();
+        for (ScopeStats& stats : p.stats) {
+            if (stats.depth == depth && stats.name == name)
+                return stats;
+        }
+        p.stats.push_back({name, depth, 0.0f, 0.0f, 0.0f, 0});
+        return p.stats.back();
+    }
+
+    void resolve(FrameQueries& frame) {
+        Profiler& p = profiler();
+        if (!frame.pending)
+            return;
+        frame.pending = false;
+        if (frame.usedQueries == 0)
+            return;
+
+        // Timestamps are written in command order, so once last one is available, all of them are
+        GLint available = 0;
+        GLCall(glGetQueryObjectiv(frame.queries[frame.usedQueries - 1], GL_QUERY_RESULT_AVAILABLE, &available));
+        if (!available) {
+            // Never wait for GPU, data of this frame is simply lost
+            p.droppedFrames++;
+            return;
+        }
+
+        for (const ScopeRecord& scope : frame.scopes) {
+            if (scope.endQuery == scope.startQuery)
+                continue;
+            GLuint64 start = 0, end = 0;
+            GLCall(glGetQueryObjectui64v(frame.queries[scope.startQuery], GL_QUERY_RESULT, &start));
+            GLCall(glGetQueryObjectui64v(frame.queries[scope.endQuery], GL_QUERY_RESULT, &end));
+            float ms = (end - start) / 1000000.0f;
+
+            ScopeStats& stats = findStats(scope.name, scope.depth);
+            stats.lastMs = ms;
+            stats.averageMs = (stats.lastFrame == 0) ? ms : stats.averageMs * 0.95f + ms * 0.05f;
+            if (ms > stats.maxMs)
+                stats.maxMs = ms;
+            stats.lastFrame = frame.frameNumber;
+
+            if (p.csv.is_open())
+                p.csv << frame.frameNumber << "," << scope.name << "," << scope.depth << "," << ms << "\n";
+        }
+        p.lastResolvedFrame = frame.frameNumber;
+    }
+}
+
+void GPUProfiler::beginFrame() {
+    Profiler& p = profiler();
+    if (!p.enabled)
+        return;
+
+    p.currentFrame = p.frameNumber % FRAME_LATENCY;
+    FrameQueries& frame = p.frames[p.currentFrame];
+    // Slot is about to be reused, so results from FRAME_LATENCY frames ago are read now
+    resolve(frame);
+
+    frame.usedQueries = 0;
+    frame.scopes.clear();
+    frame.frameNumber = p.frameNumber;
+    p.scopeStack.clear();
+    p.inFrame = true;
+
+    beginScope("Frame");
+}
+
+void GPUProfiler::endFrame() {
+    Profiler& p = profiler();
+    if (!p.inFrame)
+        return;
+
+    // Close anything left open, including the frame scope itself
+    while (!p.scopeStack.empty())
+        endScope();
+
+    p.frames[p.currentFrame].pending = true;
+    p.frameNumber++;
+    p.inFrame = false;
+}
+
+void GPUProfiler::beginScope(const char* name) {
+    Profiler& p = profiler();
+    if (!p.inFrame)
+        return;
+
+    FrameQueries& frame = p.frames[p.currentFrame];
+    ScopeRecord scope;
+    scope.name = name;
+    scope.depth = p.scopeStack.size();
+    scope.startQuery = acquireQuery(frame);
+    scope.endQuery = scope.startQuery;
+    GLCall(glQueryCounter(frame.queries[scope.startQuery], GL_TIMESTAMP));
+
+    p.scopeStack.push_back(frame.scopes.size());
+    frame.scopes.push_back(scope);
+}
+
+void GPUProfiler::endScope() {
+    Profiler& p = profiler();
+    if (!p.inFrame || p.scopeStack.empty())
+        return;
+
+    FrameQueries& frame = p.frames[p.currentFrame];
+    ScopeRecord& scope = frame.scopes[p.scopeStack.back()];
+    p.scopeStack.pop_back();
+    scope.endQuery = acquireQuery(frame);
+    GLCall(glQueryCounter(frame.queries[scope.endQuery], GL_TIMESTAMP));
+}
+
+void GPUProfiler::setEnabled(bool enabled) {
+    profiler().enabled = enabled;
+}
+
+bool GPUProfiler::isEnabled() {
+    return profiler().enabled;
+}
+
+bool GPUProfiler::startCSV(const std::string& fileName) {
+    Profiler& p = profiler();
+    p.csv.close();
+    p.csv.open(fileName);
+    if (!p.csv.is_open()) {
+        std::cout << "Could not open " << fileName << " for GPU profiler output\n";
+        return false;
+    }
+    p.csv << "# renderer: " << glGetString(GL_RENDERER) << ", version: " << glGetString(GL_VERSION) << "\n";
+    p.csv << "frame,scope,depth,gpu_ms\n";
+    return true;
+}
+
+void GPUProfiler::stopCSV() {
+    profiler().csv.close();
+}
+
+void GPUProfiler::onImGuiRender() {
+    Profiler& p = profiler();
+
+    ImGui::Begin("GPU Profiler");
+    ImGui::Checkbox("Enabled", &p.enabled);
+    bool writeCSV = p.csv.is_open();
+    if (ImGui::Checkbox("Stream to gpu_profile.csv", &writeCSV)) {
+        if (writeCSV)
+            startCSV("gpu_profile.csv");
+        else
+            stopCSV();
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Reset max")) {
+        for (ScopeStats& stats : p.stats)
+            stats.maxMs = 0.0f;
+    }
+    ImGui::Text("Frames dropped (results not ready): %u", p.droppedFrames);
+    ImGui::Separator();
+
+    for (const ScopeStats& stats : p.stats) {
+        if (stats.lastFrame + STALE_FRAMES < p.lastResolvedFrame)
+            continue;
+        ImGui::Text("%*s%-24s avg %7.3f ms  last %7.3f ms  max %7.3f ms", stats.depth * 2, "", stats.name.c_str(),
+                stats.averageMs, stats.lastMs, stats.maxMs);
+    }
+    ImGui::End();
+}
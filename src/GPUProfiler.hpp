@@ -0,0 +1,40 @@
+#ifndef __GPUProfiler__
+#define __GPUProfiler__
+
+#include <string>
+
+// Measures GPU time of named scopes using GL_TIMESTAMP queries. Queries of each frame are kept in a ring
+// and read back several frames later, only if results are already available, so profiling never stalls the pipeline.
+// Scopes can be nested and used from anywhere between beginFrame() and endFrame(), for example Test::onRender
+class GPUProfiler {
+    public:
+        static void beginFrame();
+        static void endFrame();
+
+        static void beginScope(const char* name);
+        static void endScope();
+
+        static void setEnabled(bool enabled);
+        static bool isEnabled();
+
+        // Every resolved scope gets streamed as a line of CSV, header contains GL renderer and version
+        // so results from different drivers can be told apart
+        static bool startCSV(const std::string& fileName);
+        static void stopCSV();
+
+        // Panel with per scope timings
+        static void onImGuiRender();
+};
+
+class GPUProfileScope {
+    public:
+        GPUProfileScope(const char* name) { GPUProfiler::beginScope(name); }
+        ~GPUProfileScope() { GPUProfiler::endScope(); }
+};
+
+#define GPU_PROFILE_CONCAT_IMPL(a, b) a##b
+#define GPU_PROFILE_CONCAT(a, b) GPU_PROFILE_CONCAT_IMPL(a, b)
+// Name must be string literal or otherwise outlive the frame
+#define GPU_PROFILE_SCOPE(name) GPUProfileScope GPU_PROFILE_CONCAT(gpuProfileScope, __LINE__)(name)
+
+#endif // __GPUProfiler__
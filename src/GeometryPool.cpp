@@ -0,0 +1,282 @@
+#include "GeometryPool.hpp"
+
+#include "Renderer.hpp"
+#include "GLState.hpp"
+#include "UploadQueue.hpp"
+#include "imgui/imgui.h"
+
+#include <algorithm>
+#include <string>
+
+RangeAllocator::RangeAllocator(unsigned int capacity)
+    : capacity(capacity), freeSize(capacity) {
+    if (capacity > 0)
+        freeRanges[0] = capacity;
+}
+
+bool RangeAllocator::allocate(unsigned int size, unsigned int& offset) {
+    if (size == 0) {
+        offset = 0;
+        return true;
+    }
+    for (auto it = freeRanges.begin(); it != freeRanges.end(); ++it) {
+        if (it->second < size)
+            continue;
+        offset = it->first;
+        unsigned int remaining = it->second - size;
+        freeRanges.erase(it);
+        if (remaining > 0)
+            freeRanges[offset + size] = remaining;
+        freeSize -= size;
+        return true;
+    }
+    return false;
+}
+
+void RangeAllocator::free(unsigned int offset, unsigned int size) {
+    if (size == 0)
+        return;
+    freeSize += size;
+    auto next = freeRanges.lower_bound(offset);
+    // Merge with following range
+    if (next != freeRanges.end() && offset + size == next->first) {
+        size += next->second;
+        next = freeRanges.erase(next);
+    }
+    // Merge with preceding range
+    if (next != freeRanges.begin()) {
+        auto previous = std::prev(next);
+        if (previous->first + previous->second == offset) {
+            previous->second += size;
+            return;
+        }
+    }
+    freeRanges[offset] = size;
+}
+
+unsigned int RangeAllocator::getLargestFreeRange() const {
+    unsigned int largest = 0;
+    for (const auto& range : freeRanges)
+        largest = std::max(largest, range.second);
+    return largest;
+}
+
+bool GeometryPool::Allocation::isResident() const {
+    return UploadQueue::isComplete(uploadTicket);
+}
+
+void GeometryPool::Release::operator()(Allocation* allocation) const {
+    if (allocation->pool)
+        allocation->pool->release(allocation);
+    else
+        delete allocation;
+}
+
+GeometryPool::GeometryPool(const std::vector<VertexFormatView>& streams, unsigned int blockVertices, unsigned int blockIndices)
+    : streams(streams), hash(hashVertexStreams(streams)), blockVertices(blockVertices), blockIndices(blockIndices), generation(0) {
+}
+
+GeometryPool::~GeometryPool() {
+    // Handles outliving the pool only free their own memory
+    for (Allocation* allocation : allocations)
+        allocation->pool = nullptr;
+}
+
+std::map<uint64_t, std::unique_ptr<GeometryPool>>& GeometryPool::getPools() {
+    static std::map<uint64_t, std::unique_ptr<GeometryPool>> pools;
+    return pools;
+}
+
+GeometryPool& GeometryPool::getPool(const VertexFormatView& format) {
+    return getPool(std::vector<VertexFormatView>{format});
+}
+
+GeometryPool& GeometryPool::getPool(const std::vector<VertexFormatView>& streams) {
+    // Different vertex structs with identical attributes share a pool
+    auto& pools = getPools();
+    uint64_t hash = hashVertexStreams(streams);
+    auto it = pools.find(hash);
+    if (it == pools.end())
+        it = pools.insert({hash, std::make_unique<GeometryPool>(streams)}).first;
+    return *it->second;
+}
+
+void GeometryPool::destroyAll() {
+    getPools().clear();
+}
+
+std::unique_ptr<GeometryPool::Block> GeometryPool::createBlock(unsigned int vertexCapacity, unsigned int indexCapacity,
+        GLenum indexType, GLenum mode) {
+    std::unique_ptr<Block> block = std::make_unique<Block>();
+    for (const VertexFormatView& stream : streams)
+        block->vbos.push_back(std::make_unique<VertexBuffer>(nullptr, vertexCapacity * stream.stride));
+    block->ibo = std::make_unique<IndexBuffer>(nullptr, indexCapacity, mode, indexType);
+    block->vertices = RangeAllocator(vertexCapacity);
+    block->indices = RangeAllocator(indexCapacity);
+    block->indexType = indexType;
+    block->mode = mode;
+    return block;
+}
+
+GeometryPool::Handle GeometryPool::allocate(const void* vertices, unsigned int vertexCount, const unsigned int* indices,
+        unsigned int indexCount, GLenum mode) {
+    return allocate(std::vector<const void*>{vertices}, vertexCount, indices, indexCount, mode);
+}
+
+GeometryPool::Handle GeometryPool::allocate(const std::vector<const void*>& streamVertices, unsigned int vertexCount,
+        const unsigned int* indices, unsigned int indexCount, GLenum mode) {
+    ASSERT(streamVertices.size() == streams.size());
+    // Byte indices would split pools into many more blocks for little gain, and are slow on some hardware
+    GLenum indexType = IndexBuffer::chooseType(indices, indexCount);
+    if (indexType == GL_UNSIGNED_BYTE)
+        indexType = GL_UNSIGNED_SHORT;
+
+    unsigned int blockIndex = 0;
+    unsigned int baseVertex = 0, firstIndex = 0;
+    for (; blockIndex < blocks.size(); blockIndex++) {
+        Block& block = *blocks[blockIndex];
+        if (block.indexType != indexType || block.mode != mode)
+            continue;
+        if (!block.vertices.allocate(vertexCount, baseVertex))
+            continue;
+        if (!block.indices.allocate(indexCount, firstIndex)) {
+            block.vertices.free(baseVertex, vertexCount);
+            continue;
+        }
+        break;
+    }
+    if (blockIndex == blocks.size()) {
+        // Meshes bigger than default block get a block of their own
+        blocks.push_back(createBlock(std::max(blockVertices, vertexCount), std::max(blockIndices, indexCount), indexType, mode));
+        blocks.back()->vertices.allocate(vertexCount, baseVertex);
+        blocks.back()->indices.allocate(indexCount, firstIndex);
+    }
+
+    // Data reaches the block with next UploadQueue::flush() calls, indices are enqueued last
+    Block& block = *blocks[blockIndex];
+    uint64_t uploadTicket = 0;
+    for (unsigned int stream = 0; stream < streams.size(); stream++) {
+        unsigned int stride = streams[stream].stride;
+        uploadTicket = std::max(uploadTicket, UploadQueue::enqueueBuffer(block.vbos[stream]->getRendererID(),
+                    baseVertex * stride, streamVertices[stream], vertexCount * stride));
+    }
+    if (indexCount > 0) {
+        std::vector<unsigned char> converted = IndexBuffer::convert(indices, indexCount, indexType);
+        uploadTicket = std::max(uploadTicket, UploadQueue::enqueueBuffer(block.ibo->getRendererID(),
+                    firstIndex * IndexBuffer::getTypeSize(indexType), converted.data(), converted.size()));
+    }
+
+    Allocation* allocation = new Allocation{this, blockIndex, baseVertex, vertexCount, firstIndex, indexCount, uploadTicket};
+    allocations.push_back(allocation);
+    return Handle(allocation);
+}
+
+VertexArray& GeometryPool::bindStreams(unsigned int block, unsigned int streamCount) const {
+    VertexArray& va = streamCount == 1 ? Renderer::getVertexArray(streams[0])
+        : Renderer::getVertexArray(std::vector<VertexFormatView>(streams.begin(), streams.begin() + streamCount));
+    for (unsigned int stream = 0; stream < streamCount; stream++)
+        va.bindVertexBuffer(stream, *blocks[block]->vbos[stream]);
+    return va;
+}
+
+void GeometryPool::release(Allocation* allocation) {
+    Block& block = *blocks[allocation->block];
+    block.vertices.free(allocation->baseVertex, allocation->vertexCount);
+    block.indices.free(allocation->firstIndex, allocation->indexCount);
+    allocations.erase(std::find(allocations.begin(), allocations.end(), allocation));
+    delete allocation;
+}
+
+void GeometryPool::defragment() {
+    // Pending uploads target old buffers and offsets
+    UploadQueue::finish();
+    for (unsigned int blockIndex = 0; blockIndex < blocks.size(); blockIndex++) {
+        Block& oldBlock = *blocks[blockIndex];
+        // Ranges of one buffer can't be copied over each other, so live data moves into new buffers
+        std::unique_ptr<Block> newBlock = createBlock(oldBlock.vertices.getCapacity(), oldBlock.indices.getCapacity(),
+                oldBlock.indexType, oldBlock.mode);
+        unsigned int indexSize = IndexBuffer::getTypeSize(oldBlock.indexType);
+
+        for (Allocation* allocation : allocations) {
+            if (allocation->block != blockIndex)
+                continue;
+            unsigned int baseVertex = 0;
+            newBlock->vertices.allocate(allocation->vertexCount, baseVertex);
+            // Every stream uses same vertex range
+            for (unsigned int stream = 0; stream < streams.size() && allocation->vertexCount > 0; stream++) {
+                unsigned int stride = streams[stream].stride;
+                GLState::bindBuffer(GL_COPY_READ_BUFFER, oldBlock.vbos[stream]->getRendererID());
+                GLState::bindBuffer(GL_COPY_WRITE_BUFFER, newBlock->vbos[stream]->getRendererID());
+                GLCall(glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, allocation->baseVertex * stride,
+                            baseVertex * stride, allocation->vertexCount * stride));
+            }
+            allocation->baseVertex = baseVertex;
+        }
+
+        GLState::bindBuffer(GL_COPY_READ_BUFFER, oldBlock.ibo->getRendererID());
+        GLState::bindBuffer(GL_COPY_WRITE_BUFFER, newBlock->ibo->getRendererID());
+        for (Allocation* allocation : allocations) {
+            if (allocation->block != blockIndex)
+                continue;
+            unsigned int firstIndex = 0;
+            newBlock->indices.allocate(allocation->indexCount, firstIndex);
+            if (allocation->indexCount > 0) {
+                GLCall(glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, allocation->firstIndex * indexSize,
+                            firstIndex * indexSize, allocation->indexCount * indexSize));
+            }
+            allocation->firstIndex = firstIndex;
+        }
+
+        blocks[blockIndex] = std::move(newBlock);
+    }
+    generation++;
+}
+
+GeometryPoolStats GeometryPool::getStats() const {
+    GeometryPoolStats stats;
+    stats.blockCount = blocks.size();
+    stats.allocationCount = allocations.size();
+    unsigned int largestFreeVertices = 0, largestFreeIndices = 0;
+    unsigned int freeVertices = 0, freeIndices = 0;
+    for (const auto& block : blocks) {
+        stats.vertexCapacity += block->vertices.getCapacity();
+        stats.indexCapacity += block->indices.getCapacity();
+        stats.indexBytes += block->indices.getCapacity() * IndexBuffer::getTypeSize(block->indexType);
+        freeVertices += block->vertices.getFreeSize();
+        freeIndices += block->indices.getFreeSize();
+        stats.freeRangeCount += block->vertices.getFreeRangeCount() + block->indices.getFreeRangeCount();
+        largestFreeVertices = std::max(largestFreeVertices, block->vertices.getLargestFreeRange());
+        largestFreeIndices = std::max(largestFreeIndices, block->indices.getLargestFreeRange());
+    }
+    stats.vertexUsed = stats.vertexCapacity - freeVertices;
+    stats.indexUsed = stats.indexCapacity - freeIndices;
+    if (freeVertices > 0)
+        stats.vertexFragmentation = 1.0f - static_cast<float>(largestFreeVertices) / freeVertices;
+    if (freeIndices > 0)
+        stats.indexFragmentation = 1.0f - static_cast<float>(largestFreeIndices) / freeIndices;
+    return stats;
+}
+
+void GeometryPool::onImGuiRender() {
+    ImGui::Begin("Geometry pools");
+    unsigned int poolIndex = 0;
+    for (auto& pool : getPools()) {
+        GeometryPoolStats stats = pool.second->getStats();
+        ImGui::PushID(poolIndex++);
+        std::string strides;
+        for (const VertexFormatView& stream : pool.second->getStreams())
+            strides += (strides.empty() ? "" : " + ") + std::to_string(stream.stride);
+        ImGui::Text("Stride %s bytes: %u allocations in %u blocks", strides.c_str(), stats.allocationCount, stats.blockCount);
+        ImGui::Text("Vertices %u / %u (%.1f%%), fragmentation %.2f", stats.vertexUsed, stats.vertexCapacity,
+                stats.vertexCapacity ? 100.0f * stats.vertexUsed / stats.vertexCapacity : 0.0f, stats.vertexFragmentation);
+        ImGui::Text("Indices %u / %u (%.1f%%), fragmentation %.2f", stats.indexUsed, stats.indexCapacity,
+                stats.indexCapacity ? 100.0f * stats.indexUsed / stats.indexCapacity : 0.0f, stats.indexFragmentation);
+        ImGui::Text("Index memory: %.1f KB", stats.indexBytes / 1024.0f);
+        ImGui::Text("Free ranges: %u", stats.freeRangeCount);
+        if (ImGui::Button("Defragment"))
+            pool.second->defragment();
+        ImGui::Separator();
+        ImGui::PopID();
+    }
+    ImGui::End();
+}
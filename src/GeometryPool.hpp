@@ -0,0 +1,135 @@
+#ifndef __GeometryPool__
+#define __GeometryPool__
+
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "VertexArray.hpp"
+#include "IndexBuffer.hpp"
+#include "VertexFormat.hpp"
+
+// First fit free list over [0, capacity) range, neighbouring free ranges are merged when freed
+class RangeAllocator {
+    public:
+        RangeAllocator(unsigned int capacity = 0);
+
+        bool allocate(unsigned int size, unsigned int& offset);
+        void free(unsigned int offset, unsigned int size);
+
+        inline unsigned int getCapacity() const { return capacity; }
+        inline unsigned int getFreeSize() const { return freeSize; }
+        inline unsigned int getFreeRangeCount() const { return freeRanges.size(); }
+        unsigned int getLargestFreeRange() const;
+    private:
+        unsigned int capacity;
+        unsigned int freeSize;
+        std::map<unsigned int, unsigned int> freeRanges; ///< Offset to size, ordered by offset
+};
+
+struct GeometryPoolStats {
+    unsigned int blockCount = 0;
+    unsigned int allocationCount = 0;
+    unsigned int vertexCapacity = 0;
+    unsigned int vertexUsed = 0;
+    unsigned int indexCapacity = 0;
+    unsigned int indexUsed = 0;
+    unsigned int indexBytes = 0; ///< Index storage of all blocks, depends on index types
+    unsigned int freeRangeCount = 0;
+    // 1 - largest free range / all free space, 0 means all free space is in one piece
+    float vertexFragmentation = 0.0f;
+    float indexFragmentation = 0.0f;
+};
+
+// Vertex and index data of many meshes with the same vertex format, sub allocated out of few large buffers (blocks).
+// All blocks share one VAO per vertex format (Renderer::getVertexArray()), bindBlock() only switches the vertex buffer,
+// so meshes draw with glDrawElementsBaseVertex without creating any GL objects of their own.
+// Vertices can also be split into several streams (e.g. positions and everything else), each block then has one
+// buffer per stream with same vertex ranges, and depth only passes bind just the first stream with bindStreams(). Indices stay relative to the mesh's first vertex,
+// so they are stored as 16 bit unless a single mesh has more vertices. Each block holds one index type and
+// one mode (triangle list or strips), meshes only go to blocks matching both.
+// Pools are shared per vertex format or list of streams (keyed by compile time hash) through getPool() and must be destroyed
+// with destroyAll() while context exists
+class GeometryPool {
+    public:
+        struct Allocation {
+            GeometryPool* pool;
+            unsigned int block;
+            unsigned int baseVertex;
+            unsigned int vertexCount;
+            unsigned int firstIndex;
+            unsigned int indexCount;
+            uint64_t uploadTicket; ///< Last upload of its data, see UploadQueue::isComplete()
+
+            // Drawing before data arrived would read undefined indices and vertices
+            bool isResident() const;
+        };
+
+        struct Release {
+            void operator()(Allocation* allocation) const;
+        };
+        // Frees its range when destroyed, offsets inside may change with defragment()
+        using Handle = std::unique_ptr<Allocation, Release>;
+
+        GeometryPool(const std::vector<VertexFormatView>& streams, unsigned int blockVertices = 1 << 18,
+                unsigned int blockIndices = 1 << 20);
+        ~GeometryPool();
+
+        GeometryPool(const GeometryPool&) = delete;
+        GeometryPool& operator=(const GeometryPool&) = delete;
+
+        static GeometryPool& getPool(const VertexFormatView& format);
+        static GeometryPool& getPool(const std::vector<VertexFormatView>& streams);
+        static void destroyAll();
+        // Window with statistics of every pool and defragment button
+        static void onImGuiRender();
+
+        // Vertex data must match the format, new block is created if none has enough space.
+        // Strip indices are separated by IndexBuffer::RESTART_INDEX
+        Handle allocate(const void* vertices, unsigned int vertexCount, const unsigned int* indices, unsigned int indexCount,
+                GLenum mode = GL_TRIANGLES);
+        // One pointer per stream, each to vertexCount vertices of that stream's format
+        Handle allocate(const std::vector<const void*>& streamVertices, unsigned int vertexCount, const unsigned int* indices,
+                unsigned int indexCount, GLenum mode = GL_TRIANGLES);
+
+        // Moves all allocations of each block to the start of new buffers, leaving free space in one range.
+        // Buffers get replaced, so anything which references them (VAOs, draw commands) must check getGeneration()
+        void defragment();
+        // Changes every time buffers of existing blocks are replaced
+        inline unsigned int getGeneration() const { return generation; }
+
+        // Attaches block's vertex buffers to binding points of the shared VAO of pool's streams and returns it
+        VertexArray& bindBlock(unsigned int block) const { return bindStreams(block, streams.size()); }
+        // Same with only first streamCount streams, VAO is the one of those streams alone
+        VertexArray& bindStreams(unsigned int block, unsigned int streamCount) const;
+        const VertexBuffer& getVertexBuffer(unsigned int block, unsigned int stream = 0) const { return *blocks[block]->vbos[stream]; }
+        const IndexBuffer& getIndexBuffer(unsigned int block) const { return *blocks[block]->ibo; }
+        inline const std::vector<VertexFormatView>& getStreams() const { return streams; }
+        inline uint64_t getHash() const { return hash; }
+
+        GeometryPoolStats getStats() const;
+    private:
+        struct Block {
+            std::vector<std::unique_ptr<VertexBuffer>> vbos; ///< One per stream
+            std::unique_ptr<IndexBuffer> ibo;
+            RangeAllocator vertices;
+            RangeAllocator indices;
+            GLenum indexType;
+            GLenum mode;
+        };
+
+        std::vector<VertexFormatView> streams;
+        uint64_t hash; ///< Of all streams
+        unsigned int blockVertices;
+        unsigned int blockIndices;
+        unsigned int generation;
+        std::vector<std::unique_ptr<Block>> blocks;
+        std::vector<Allocation*> allocations;
+
+        std::unique_ptr<Block> createBlock(unsigned int vertexCapacity, unsigned int indexCapacity, GLenum indexType, GLenum mode);
+        void release(Allocation* allocation);
+
+        static std::map<uint64_t, std::unique_ptr<GeometryPool>>& getPools();
+};
+
+#endif // __GeometryPool__
@@ -0,0 +1,155 @@
+#include "Image.hpp"
+
+#include "stb_image.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace {
+    unsigned int crcTable[256];
+    bool crcTableReady = false;
+
+    unsigned int crc32(const unsigned char* data, size_t size, unsigned int crc = 0xFFFFFFFF) {
+        if (!crcTableReady) {
+            for (unsigned int i = 0; i < 256; i++) {
+                unsigned int c = i;
+                for (int k = 0; k < 8; k++)
+                    c = (c & 1) ? 0xEDB88320 ^ (c >> 1) : c >> 1;
+                crcTable[i] = c;
+            }
+            crcTableReady = true;
+        }
+        for (size_t i = 0; i < size; i++)
+            crc = crcTable[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+        return crc;
+    }
+
+    void appendUint32(std::vector<unsigned char>& out, unsigned int value) {
+        out.push_back(value >> 24);
+        out.push_back(value >> 16);
+        out.push_back(value >> 8);
+        out.push_back(value);
+    }
+
+    void writeChunk(std::ofstream& out, const char* type, const std::vector<unsigned char>& data) {
+        std::vector<unsigned char> chunk;
+        appendUint32(chunk, data.size());
+        chunk.insert(chunk.end(), type, type + 4);
+        chunk.insert(chunk.end(), data.begin(), data.end());
+        // CRC covers type and data, but not length
+        appendUint32(chunk, crc32(chunk.data() + 4, chunk.size() - 4) ^ 0xFFFFFFFF);
+        out.write(reinterpret_cast<const char*>(chunk.data()), chunk.size());
+    }
+}
+
+Image::Image()
+    : width(0), height(0) {
+}
+
+Image::Image(int width, int height)
+    : width(width), height(height), pixels(width * height * 4, 0) {
+}
+
+bool Image::loadPNG(const std::string& fileName) {
+    // Flag is global and Texture sets it too, images here are always kept top row first
+    stbi_set_flip_vertically_on_load(0);
+    int channels;
+    unsigned char* data = stbi_load(fileName.c_str(), &width, &height, &channels, 4);
+    if (!data) {
+        width = height = 0;
+        pixels.clear();
+        return false;
+    }
+    pixels.assign(data, data + width * height * 4);
+    stbi_image_free(data);
+    return true;
+}
+
+bool Image::savePNG(const std::string& fileName) const {
+    std::ofstream out(fileName, std::ios::binary);
+    if (!out.is_open()) {
+        std::cout << "Could not open " << fileName << " for writing\n";
+        return false;
+    }
+
+    const unsigned char signature[8] = {137, 'P', 'N', 'G', '\r', '\n', 26, '\n'};
+    out.write(reinterpret_cast<const char*>(signature), 8);
+
+    std::vector<unsigned char> header;
+    appendUint32(header, width);
+    appendUint32(header, height);
+    header.push_back(8); // bit depth
+    header.push_back(6); // RGBA
+    header.push_back(0); // deflate
+    header.push_back(0); // adaptive filtering
+    header.push_back(0); // no interlace
+    writeChunk(out, "IHDR", header);
+
+    // Every scanline starts with filter type byte, 0 - none
+    size_t rowSize = width * 4;
+    std::vector<unsigned char> raw;
+    raw.reserve((rowSize + 1) * height);
+    for (int y = 0; y < height; y++) {
+        raw.push_back(0);
+        raw.insert(raw.end(), pixels.begin() + y * rowSize, pixels.begin() + (y + 1) * rowSize);
+    }
+
+    // zlib stream made of stored deflate blocks, each can hold up to 65535 bytes
+    std::vector<unsigned char> zlib = {0x78, 0x01};
+    size_t offset = 0;
+    do {
+        size_t blockSize = std::min<size_t>(65535, raw.size() - offset);
+        bool last = offset + blockSize == raw.size();
+        zlib.push_back(last ? 1 : 0);
+        zlib.push_back(blockSize & 0xFF);
+        zlib.push_back(blockSize >> 8);
+        zlib.push_back(~blockSize & 0xFF);
+        zlib.push_back((~blockSize >> 8) & 0xFF);
+        zlib.insert(zlib.end(), raw.begin() + offset, raw.begin() + offset + blockSize);
+        offset += blockSize;
+    } while (offset < raw.size());
+
+    unsigned int a = 1, b = 0;
+    for (unsigned char byte : raw) {
+        a = (a + byte) % 65521;
+        b = (b + a) % 65521;
+    }
+    appendUint32(zlib, (b << 16) | a);
+
+    writeChunk(out, "IDAT", zlib);
+    writeChunk(out, "IEND", {});
+    return out.good();
+}
+
+ImageComparison Image::compare(const Image& expected, const Image& actual, int tolerance, Image& diff) {
+    ImageComparison result;
+    diff = Image(expected.width, expected.height);
+    if (expected.width != actual.width || expected.height != actual.height) {
+        result.mismatchedPixels = expected.width * expected.height;
+        result.maxDifference = 255;
+        return result;
+    }
+
+    for (size_t i = 0; i < expected.pixels.size(); i += 4) {
+        int pixelDifference = 0;
+        for (int c = 0; c < 4; c++) {
+            pixelDifference = std::max(pixelDifference, std::abs(expected.pixels[i + c] - actual.pixels[i + c]));
+        }
+        result.maxDifference = std::max(result.maxDifference, pixelDifference);
+
+        if (pixelDifference > tolerance) {
+            result.mismatchedPixels++;
+            diff.pixels[i] = 255;
+            diff.pixels[i + 1] = 0;
+            diff.pixels[i + 2] = 0;
+        } else {
+            for (int c = 0; c < 3; c++)
+                diff.pixels[i + c] = expected.pixels[i + c] / 4;
+        }
+        diff.pixels[i + 3] = 255;
+    }
+    return result;
+}
@@ -0,0 +1,36 @@
+#ifndef __Image__
+#define __Image__
+
+#include <string>
+#include <vector>
+
+struct ImageComparison {
+    unsigned int mismatchedPixels = 0;
+    int maxDifference = 0; ///< Largest per channel difference found
+};
+
+// 8 bit RGBA image stored top row first, used by golden image tests.
+// PNGs are read with stb_image, written uncompressed (stored deflate blocks), since no encoder is vendored
+class Image {
+    public:
+        Image();
+        Image(int width, int height);
+
+        bool loadPNG(const std::string& fileName);
+        bool savePNG(const std::string& fileName) const;
+
+        // Pixels differing by more than tolerance in any channel are counted as mismatch
+        // and painted red in diff image, matching pixels are kept as dimmed copy of expected image
+        static ImageComparison compare(const Image& expected, const Image& actual, int tolerance, Image& diff);
+
+        inline int getWidth() const { return width; }
+        inline int getHeight() const { return height; }
+        inline unsigned char* getPixels() { return pixels.data(); }
+        inline const unsigned char* getPixels() const { return pixels.data(); }
+    private:
+        int width;
+        int height;
+        std::vector<unsigned char> pixels;
+};
+
+#endif // __Image__
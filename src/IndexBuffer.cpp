@@ -1,24 +1,85 @@
 #include "IndexBuffer.hpp"
 
 #include "Renderer.hpp"
+#include "GLState.hpp"
+#include "UploadQueue.hpp"
 
-IndexBuffer::IndexBuffer(const unsigned int* data, unsigned int cnt)
-    : count(cnt) {
-    GLCall(glGenBuffers(1, &rendererID));
-    GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, rendererID));
-    // Keep in mind there is a slim chance unsigned int on some platforms will not be 4 bytes, in that case use GLUint
-    GLCall(glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * sizeof(unsigned int), data, GL_STATIC_DRAW));
+#include <cstdint>
+#include <cstring>
+
+IndexBuffer::IndexBuffer(const unsigned int* data, unsigned int cnt, GLenum mode, GLenum type)
+    : rendererID(BufferHandle::create()), count(cnt), mode(mode), type(type), uploadTicket(0) {
+    if (type == GL_NONE)
+        this->type = data ? chooseType(data, count) : GL_UNSIGNED_INT;
+
+    GLState::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, rendererID.get());
+    // Only storage is created here, indices arrive with next UploadQueue::flush()
+    GLCall(glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * getTypeSize(), nullptr, GL_STATIC_DRAW));
+    if (data) {
+        std::vector<unsigned char> converted = convert(data, count, this->type);
+        uploadTicket = UploadQueue::enqueueBuffer(rendererID.get(), 0, converted.data(), converted.size());
+    }
+}
+
+bool IndexBuffer::isResident() const {
+    return UploadQueue::isComplete(uploadTicket);
 }
 
 IndexBuffer::~IndexBuffer() {
-    GLCall(glDeleteBuffers(1, &rendererID));
+    UploadQueue::cancelBuffer(rendererID.get());
 }
 
 void IndexBuffer::bind() const {
-    GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, rendererID));
+    GLState::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, rendererID.get());
+    GLState::setPrimitiveRestart(mode == GL_TRIANGLE_STRIP ? type : GL_NONE);
 }
 
 void IndexBuffer::unbind() const {
-    GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0));
+    GLState::bindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
+
+GLenum IndexBuffer::chooseType(const unsigned int* data, unsigned int cnt) {
+    unsigned int maxIndex = 0;
+    for (unsigned int i = 0; i < cnt; i++) {
+        if (data[i] != RESTART_INDEX && data[i] > maxIndex)
+            maxIndex = data[i];
+    }
+    // Strictly less, largest value of each type is its restart index
+    if (maxIndex < 0xFF)
+        return GL_UNSIGNED_BYTE;
+    if (maxIndex < 0xFFFF)
+        return GL_UNSIGNED_SHORT;
+    return GL_UNSIGNED_INT;
 }
 
+unsigned int IndexBuffer::getTypeSize(GLenum type) {
+    switch (type) {
+        case GL_UNSIGNED_BYTE:  return 1;
+        case GL_UNSIGNED_SHORT: return 2;
+        case GL_UNSIGNED_INT:   return 4;
+    }
+    return 0;
+}
+
+unsigned int IndexBuffer::getRestartIndex(GLenum type) {
+    switch (type) {
+        case GL_UNSIGNED_BYTE:  return 0xFF;
+        case GL_UNSIGNED_SHORT: return 0xFFFF;
+    }
+    return 0xFFFFFFFF;
+}
+
+std::vector<unsigned char> IndexBuffer::convert(const unsigned int* data, unsigned int cnt, GLenum type) {
+    std::vector<unsigned char> converted(cnt * getTypeSize(type));
+    if (type == GL_UNSIGNED_BYTE) {
+        for (unsigned int i = 0; i < cnt; i++)
+            converted[i] = static_cast<uint8_t>(data[i] == RESTART_INDEX ? 0xFF : data[i]);
+    } else if (type == GL_UNSIGNED_SHORT) {
+        uint16_t* indices = reinterpret_cast<uint16_t*>(converted.data());
+        for (unsigned int i = 0; i < cnt; i++)
+            indices[i] = static_cast<uint16_t>(data[i] == RESTART_INDEX ? 0xFFFF : data[i]);
+    } else {
+        std::memcpy(converted.data(), data, cnt * sizeof(unsigned int));
+    }
+    return converted;
+}
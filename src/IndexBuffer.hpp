@@ -1,18 +1,52 @@
 #ifndef __IndexBuffer__
 #define __IndexBuffer__
 
+#include <GL/glew.h>
+#include <cstdint>
+#include <vector>
+
+#include "GLHandle.hpp"
+
+// Indices are always given as unsigned int, but stored in the smallest type able to address every referenced vertex,
+// so small meshes need 1 or 2 bytes per index instead of 4. Largest value of the type is kept for primitive restart.
+// Triangle strips separate strips with RESTART_INDEX, which gets replaced by restart value of the stored type
 class IndexBuffer {
     public:
-        IndexBuffer(const unsigned int* data, unsigned int cnt);
+        // Restart marker in source indices, see Stripifier
+        static const unsigned int RESTART_INDEX = 0xFFFFFFFF;
+
+        // GL_NONE type picks it from the indices, nullptr data must pass type explicitly
+        IndexBuffer(const unsigned int* data, unsigned int cnt, GLenum mode = GL_TRIANGLES, GLenum type = GL_NONE);
         ~IndexBuffer();
 
+        IndexBuffer(const IndexBuffer&) = delete;
+        IndexBuffer& operator=(const IndexBuffer&) = delete;
+
+        // Also enables primitive restart for strips and disables it for lists, so bind right before drawing
         void bind() const;
         void unbind() const;
 
+        // False until indices uploaded through UploadQueue arrive, drawing before would read undefined indices
+        bool isResident() const;
+
         inline unsigned int getCount() const { return count; }
+        inline unsigned int getRendererID() const { return rendererID.get(); }
+        inline GLenum getType() const { return type; }
+        inline GLenum getMode() const { return mode; }
+        inline unsigned int getTypeSize() const { return getTypeSize(type); }
+
+        // Smallest of GL_UNSIGNED_BYTE, GL_UNSIGNED_SHORT and GL_UNSIGNED_INT holding every index except RESTART_INDEX
+        static GLenum chooseType(const unsigned int* data, unsigned int cnt);
+        static unsigned int getTypeSize(GLenum type);
+        static unsigned int getRestartIndex(GLenum type);
+        // Converts indices to given type, RESTART_INDEX becomes restart value of that type
+        static std::vector<unsigned char> convert(const unsigned int* data, unsigned int cnt, GLenum type);
     private:
-        unsigned int rendererID;
+        BufferHandle rendererID;
         unsigned int count; //<<< Numner of indices
+        GLenum mode; ///< GL_TRIANGLES or GL_TRIANGLE_STRIP with restarts
+        GLenum type;
+        uint64_t uploadTicket;
 };
 
 #endif // __IndexBuffer__
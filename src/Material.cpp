@@ -0,0 +1,77 @@
+#include "Material.hpp"
+
+#include <cstring>
+#include <iostream>
+
+Material::Material()
+    : shader(nullptr), id(nextID()), anyDirty(false) {
+}
+
+Material::Material(const Shader& shader)
+    : shader(&shader), id(nextID()), anyDirty(false) {
+    values.assign(shader.getUniformDataSize(), 0);
+    owned.assign(shader.getUniforms().size(), false);
+    dirty.assign(owned.size(), false);
+}
+
+Material::Material(const Material& other)
+    : shader(other.shader), id(nextID()), values(other.values), owned(other.owned), dirty(other.dirty),
+    anyDirty(other.anyDirty) {
+}
+
+Material& Material::operator=(const Material& other) {
+    shader = other.shader;
+    id = nextID();
+    values = other.values;
+    owned = other.owned;
+    dirty = other.dirty;
+    anyDirty = other.anyDirty;
+    return *this;
+}
+
+int Material::find(UniformName name) const {
+    return shader ? shader->findUniform(name) : -1;
+}
+
+bool Material::setData(int index, const void* data, unsigned int size) {
+    if (index < 0)
+        return false;
+    const ShaderUniform& uniform = shader->getUniforms()[index];
+    if (uniform.size != size) {
+        std::cout << "Material parameter '" << uniform.name << "' is " << uniform.size << " bytes, got " << size << "\n";
+        return false;
+    }
+    unsigned char* value = &values[uniform.offset];
+    if (owned[index] && std::memcmp(value, data, size) == 0)
+        return true;
+    std::memcpy(value, data, size);
+    owned[index] = true;
+    dirty[index] = true;
+    anyDirty = true;
+    return true;
+}
+
+void Material::apply() const {
+    if (!shader)
+        return;
+    shader->bind();
+    // Shader still holds values of this material, only changes need uploading
+    bool reapply = shader->getAppliedMaterial() != id;
+    if (!reapply && !anyDirty)
+        return;
+
+    const std::vector<ShaderUniform>& uniforms = shader->getUniforms();
+    for (unsigned int i = 0; i < uniforms.size(); i++) {
+        if (owned[i] && (reapply || dirty[i]))
+            shader->uploadUniform(i, &values[uniforms[i].offset]);
+    }
+    dirty.assign(dirty.size(), false);
+    anyDirty = false;
+    shader->setAppliedMaterial(id);
+}
+
+uint64_t Material::nextID() {
+    // 0 is reserved for "values unknown"
+    static uint64_t id = 0;
+    return ++id;
+}
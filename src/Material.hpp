@@ -0,0 +1,45 @@
+#ifndef __Material__
+#define __Material__
+
+#include <cstdint>
+#include <vector>
+
+#include "Shader.hpp"
+
+// CPU copy of shader parameters (uniforms outside of blocks, as reflected when program links).
+// apply() uploads only parameters changed since this material was last applied, and of those only values
+// program doesn't hold already, so many meshes sharing a program with mostly equal values cost few glUniform calls.
+// Parameters never set are left alone, those which are set must not also be set through Uniform handles
+class Material {
+    public:
+        Material();
+        explicit Material(const Shader& shader);
+        // Copies get their own identity, so applying them uploads their values again
+        Material(const Material& other);
+        Material& operator=(const Material& other);
+
+        // Index of parameter, -1 if shader has no such uniform outside of blocks
+        int find(UniformName name) const;
+        // Type must match the uniform (int for samplers and bools), returns false if it doesn't or index is -1
+        template <typename T>
+        bool set(int index, const T& value) { return setData(index, &value, sizeof(T)); }
+        template <typename T>
+        bool set(UniformName name, const T& value) { return set(find(name), value); }
+
+        // Binds shader and uploads what changed
+        void apply() const;
+
+        const Shader* getShader() const { return shader; }
+    private:
+        const Shader* shader;
+        uint64_t id; ///< Unique per instance, shader remembers which material it holds values of
+        std::vector<unsigned char> values;
+        std::vector<bool> owned;         ///< Set at least once
+        mutable std::vector<bool> dirty; ///< Changed since last apply()
+        mutable bool anyDirty;
+
+        bool setData(int index, const void* data, unsigned int size);
+        static uint64_t nextID();
+};
+
+#endif // __Material__
@@ -1,74 +1,106 @@
 #include "Mesh.hpp"
 
 #include "Renderer.hpp"
-#include "VertexBufferLayout.hpp"
 #include <iostream>
 
-Mesh::Mesh(std::vector<Vertex> vertices, std::vector<unsigned int> indices, std::vector<Texture*> textures, glm::vec4 diffuse) {
+Mesh::Mesh(std::vector<Vertex> vertices, std::vector<unsigned int> indices, std::vector<Texture*> textures, glm::vec4 diffuse, GLenum mode,
+        bool splitStreams) {
     Vertices = vertices;
     Indices = indices;
     Textures = textures;
 
     diffuseColor = diffuse;
+    Mode = mode;
+    SplitStreams = splitStreams;
 
     setupMesh();
 }
 
-void Mesh::draw(Shader &shader) {
-    unsigned int diffuseIndex = 1;
-    unsigned int specularIndex = 1;
-    for (unsigned int i = 0; i < Textures.size(); i++) {
+void Mesh::setMaterial(Shader& shader) {
+    if (material.getShader() != &shader || shader.getRendererID() != materialProgram) {
+        materialProgram = shader.getRendererID();
+        material = Material(shader);
+        for (unsigned int i = 0; i < samplerNames.size(); i++)
+            material.set(samplerNames[i], static_cast<int>(i));
+        diffuseColorParameter = material.find("material.diffuseColor");
+    }
+
+    for (unsigned int i = 0; i < Textures.size(); i++)
         Textures[i]->bind(i);
-        std::string slot;
-        std::string type = Textures[i]->getType();
-        if (type == "texture_diffuse")
-            slot = std::to_string(diffuseIndex++);
-        else if (type == "texture_specular")
-            slot = std::to_string(specularIndex++);
+    // TODO: need to check if color set when loading mesh and pass color as uniform here as well
+    // Only marks parameter dirty if color actually changed
+    material.set(diffuseColorParameter, diffuseColor);
+    material.apply();
+}
 
-        // TODO: need to check if color set when loading mesh and pass color as uniform here as well
-        shader.setUniform1i("material." + type + slot, i);
-    }
-    shader.setUniformVec4("material.diffuseColor", diffuseColor);
+void Mesh::draw(Shader &shader) {
+    // Material needs reflection of linked program, renderer would skip the draw anyway
+    if (!shader.isReady() || !geometry->isResident())
+        return;
+    setMaterial(shader);
+
+    Renderer renderer;
+    GeometryPool& pool = getPool();
+    renderer.drawBaseVertex(pool.bindBlock(geometry->block), pool.getIndexBuffer(geometry->block), shader,
+            geometry->indexCount, geometry->baseVertex, geometry->firstIndex);
+}
+
+void Mesh::drawDepthOnly(Shader &shader) {
+    if (!geometry->isResident())
+        return;
+    Renderer renderer;
+    GeometryPool& pool = getPool();
+    renderer.drawBaseVertex(pool.bindStreams(geometry->block, 1), pool.getIndexBuffer(geometry->block), shader,
+            geometry->indexCount, geometry->baseVertex, geometry->firstIndex);
+}
+
+void Mesh::drawInstanced(Shader &shader, unsigned int amount, VertexArray* vao) {
+    if (!shader.isReady() || !geometry->isResident())
+        return;
+    setMaterial(shader);
 
     Renderer renderer;
-    renderer.draw(*vao, *ibo, shader);
+    GeometryPool& pool = getPool();
+    if (vao) {
+        for (unsigned int stream = 0; stream < pool.getStreams().size(); stream++)
+            vao->bindVertexBuffer(stream, pool.getVertexBuffer(geometry->block, stream));
+    }
+    renderer.drawInstancedBaseVertex(vao ? *vao : pool.bindBlock(geometry->block), pool.getIndexBuffer(geometry->block), shader,
+            geometry->indexCount, geometry->baseVertex, amount, geometry->firstIndex);
 }
 
-void Mesh::drawInstanced(Shader &shader, unsigned int amount) {
+std::vector<std::string> Mesh::getSamplerNames(const std::vector<Texture*>& textures) {
+    std::vector<std::string> names;
     unsigned int diffuseIndex = 1;
     unsigned int specularIndex = 1;
-    for (unsigned int i = 0; i < Textures.size(); i++) {
-        Textures[i]->bind(i);
+    for (Texture* texture : textures) {
         std::string slot;
-        std::string type = Textures[i]->getType();
+        std::string type = texture->getType();
         if (type == "texture_diffuse")
             slot = std::to_string(diffuseIndex++);
         else if (type == "texture_specular")
             slot = std::to_string(specularIndex++);
-
-        shader.setUniform1i("material." + type + slot, i);
+        names.push_back("material." + type + slot);
     }
-    shader.setUniformVec4("material.diffuseColor", diffuseColor);
-
-    Renderer renderer;
-    renderer.drawInstanced(*vao, *ibo, shader, amount);
+    return names;
 }
 
-
 void Mesh::setupMesh() {
-    vao = std::make_unique<VertexArray>();
-    vbo = std::make_unique<VertexBuffer>(Vertices.data(), Vertices.size() * sizeof(Vertex));
-
-    VertexBufferLayout layout;
-    layout.push<float>(3); // position
-    layout.push<float>(3); // normal
-    layout.push<float>(2); // texCoords
+    samplerNames = getSamplerNames(Textures);
 
-    vao->addBuffer(*vbo, layout);
-
-    // Generate and bind index buffer object
-    ibo = std::make_unique<IndexBuffer>(Indices.data(), Indices.size());
+    // Instead of buffers and vao of its own, mesh gets a range inside shared buffers of its vertex format
+    if (!SplitStreams) {
+        geometry = GeometryPool::getPool(MeshVertexFormat::view()).allocate(Vertices.data(), Vertices.size(), Indices.data(), Indices.size(), Mode);
+        return;
+    }
 
+    std::vector<VertexPosition> positions(Vertices.size());
+    std::vector<VertexAttributes> attributes(Vertices.size());
+    for (unsigned int i = 0; i < Vertices.size(); i++) {
+        positions[i].Position = Vertices[i].Position;
+        attributes[i] = {Vertices[i].Normal, Vertices[i].TexCoords};
+    }
+    geometry = GeometryPool::getPool({PositionStreamFormat::view(), AttributeStreamFormat::view()})
+        .allocate({positions.data(), attributes.data()}, Vertices.size(), Indices.data(), Indices.size(), Mode);
 }
 
@@ -4,9 +4,10 @@
 #include <vector>
 #include <memory>
 #include "Vertex.hpp"
-#include "VertexArray.hpp"
+#include "GeometryPool.hpp"
 #include "Texture.hpp"
 #include "Shader.hpp"
+#include "Material.hpp"
 
 class Mesh {
     public:
@@ -15,24 +16,46 @@ class Mesh {
         std::vector<Texture*> Textures;
 
         glm::vec4 diffuseColor;
+        GLenum Mode; ///< GL_TRIANGLES or GL_TRIANGLE_STRIP, strips separated by IndexBuffer::RESTART_INDEX
+        bool SplitStreams; ///< Positions stored apart from other attributes, makes drawDepthOnly() fetch less
 
         Mesh(std::vector<Vertex> vertices,
                 std::vector<unsigned int> indices,
                 std::vector<Texture*> textures,
-                glm::vec4 diffuse = glm::vec4(1.0f, 1.0f, 1.0f, 1.0f));
+                glm::vec4 diffuse = glm::vec4(1.0f, 1.0f, 1.0f, 1.0f),
+                GLenum mode = GL_TRIANGLES,
+                bool splitStreams = false);
         void draw(Shader &shader);
-        void drawInstanced(Shader &shader, unsigned int amount);
-        VertexArray* getVao() { return vao.get(); }
+        // Binds only positions, for depth or stencil only passes. Shader must not read other attributes,
+        // no textures or material uniforms are set
+        void drawDepthOnly(Shader &shader);
+        // Custom vao must have formats of pool's streams set on first binding points (see VertexArray::setFormats()),
+        // mesh binds its pool buffers there before drawing. Following binding points are free for e.g. instanced attributes
+        void drawInstanced(Shader &shader, unsigned int amount, VertexArray* vao = nullptr);
+
+        // Geometry lives in shared pool of this vertex format, range inside it may move with GeometryPool::defragment()
+        const GeometryPool::Allocation& getGeometry() const { return *geometry; }
+        GeometryPool& getPool() const { return *geometry->pool; }
+        const VertexBuffer& getVertexBuffer(unsigned int stream = 0) const { return getPool().getVertexBuffer(geometry->block, stream); }
+        // Sampler uniform of each texture, "material.texture_diffuse1", "material.texture_specular1" and so on
+        static std::vector<std::string> getSamplerNames(const std::vector<Texture*>& textures);
+
         // TODO: delete textures in here?
         // ~Mesh() {}
     private:
-        //unsigned int VBO, VAO, EBO;
-        std::unique_ptr<VertexArray> vao;
-        std::unique_ptr<VertexBuffer> vbo;
-        std::unique_ptr<IndexBuffer> ibo;
+        GeometryPool::Handle geometry;
 
+        // Sampler uniform names ("material.texture_diffuse1", ...), built once from Textures
+        std::vector<std::string> samplerNames;
+        // Parameters for the program mesh was last drawn with, so drawing again does no string work
+        // and uploads only values program does not hold already
+        unsigned int materialProgram = 0;
+        Material material;
+        int diffuseColorParameter = -1;
 
         void setupMesh();
+        // Binds textures and applies material, which is built again only when program changes
+        void setMaterial(Shader& shader);
 };
 
 #endif // __Mesh__
@@ -1,5 +1,8 @@
 #include "Model.hpp"
 
+#include "CPUProfiler.hpp"
+#include "Stripifier.hpp"
+
 #include <iostream>
 
 void Model::draw(Shader& shader) {
@@ -8,13 +11,30 @@ void Model::draw(Shader& shader) {
     }
 }
 
+void Model::drawDepthOnly(Shader& shader) {
+    for (unsigned int i = 0; i < meshes.size(); i++) {
+        meshes[i].drawDepthOnly(shader);
+    }
+}
+
+void Model::drawIndirect(Shader& shader) {
+    if (!batch) {
+        batch = std::make_unique<ModelBatch>();
+        batch->add(*this);
+    }
+    batch->draw(shader);
+}
+
 void Model::loadModel(std::string path) {
+    PROFILE_FUNCTION();
     Assimp::Importer importer;
     // While loading scene, tell assimp to make sure uv coords are flipped along y axis
     // and all primitives are triangles
+    // Joining identical vertices lets triangles share them, without it indices never repeat,
+    // strips can't be formed and most meshes would need 32 bit indices
     // Other useful options:
     // aiProcess_GenNormals
-    const aiScene* scene = importer.ReadFile(path, aiProcess_Triangulate);// | aiProcess_FlipUVs);
+    const aiScene* scene = importer.ReadFile(path, aiProcess_Triangulate | aiProcess_JoinIdenticalVertices);// | aiProcess_FlipUVs);
 
     if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) {
         std::cout << "ASSIMP ERROR: " << importer.GetErrorString() << std::endl;
@@ -92,7 +112,10 @@ Mesh Model::processMesh(aiMesh* mesh, const aiScene* scene) {
         textures.insert(textures.end(), specularMaps->begin(), specularMaps->end());
     }
 
-    return Mesh(vertices, indices, textures, diffuseColor);
+    std::vector<unsigned int> strips;
+    if (stripify && Stripifier::stripify(indices, strips))
+        return Mesh(vertices, strips, textures, diffuseColor, GL_TRIANGLE_STRIP, splitStreams);
+    return Mesh(vertices, indices, textures, diffuseColor, GL_TRIANGLES, splitStreams);
 }
 
 std::vector<Texture*>* Model::loadMaterialTextures(aiMaterial* mat, aiTextureType type, std::string typeName) {
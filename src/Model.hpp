@@ -2,6 +2,7 @@
 #define __Model__
 
 #include "Mesh.hpp"
+#include "ModelBatch.hpp"
 
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
@@ -11,13 +12,27 @@
 // and loading using assimp loading interface
 class Model {
     public:
-        Model (const char* path) { loadModel(path); }
+        // With stripify, meshes are stored as triangle strips when that needs fewer indices.
+        // With splitStreams, positions are stored apart for cheaper drawDepthOnly()
+        Model (const char* path, bool stripify = false, bool splitStreams = false)
+            : stripify(stripify), splitStreams(splitStreams) { loadModel(path); }
         void draw(Shader& shader);
+        // Positions only, e.g. for depth prepass or stencil mask
+        void drawDepthOnly(Shader& shader);
+        // Draws all meshes with one multi draw indirect call, shader must read per draw data
+        // the way modelsIndirect.glsl does
+        void drawIndirect(Shader& shader);
+        // Multi draw calls issued by last drawIndirect()
+        unsigned int getIndirectDrawCallCount() const { return batch ? batch->getDrawCallCount() : 0; }
 
         std::vector<Mesh>* getMeshes() { return &meshes; }
     private:
         std::vector<Mesh> meshes;
         std::string directory;
+        bool stripify;
+        bool splitStreams;
+        // Created on first drawIndirect()
+        std::unique_ptr<ModelBatch> batch;
 
         void loadModel(std::string path);
         void processNode(aiNode* node, const aiScene* scene);
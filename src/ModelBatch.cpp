@@ -0,0 +1,138 @@
+#include "ModelBatch.hpp"
+
+#include "Model.hpp"
+#include "Renderer.hpp"
+#include "UploadQueue.hpp"
+
+#include <algorithm>
+
+ModelBatch::ModelBatch()
+    : vaoFormat(0), uniformProgram(0), uploadTicket(0), dirty(true), drawCallCount(0) {
+}
+
+unsigned int ModelBatch::add(Model& model, const glm::mat4& transform) {
+    models.push_back({&model, transform, 0});
+    dirty = true;
+    return models.size() - 1;
+}
+
+void ModelBatch::setTransform(unsigned int modelIndex, const glm::mat4& transform) {
+    ModelEntry& entry = models[modelIndex];
+    entry.transform = transform;
+    // Will be picked up by build() anyway
+    if (dirty)
+        return;
+
+    unsigned int meshCount = entry.model->getMeshes()->size();
+    for (unsigned int i = 0; i < meshCount; i++) {
+        drawData[entry.firstDraw + i].model = transform;
+    }
+    // Models changed in same frame are uploaded together on next draw()
+    drawDataVbo->updateRange(entry.firstDraw * sizeof(DrawData), meshCount * sizeof(DrawData), &drawData[entry.firstDraw]);
+}
+
+unsigned int ModelBatch::getMeshCount() const {
+    unsigned int count = 0;
+    for (const ModelEntry& entry : models) {
+        count += entry.model->getMeshes()->size();
+    }
+    return count;
+}
+
+void ModelBatch::build() {
+    drawData.clear();
+    bindings.clear();
+    groups.clear();
+    uniformProgram = 0;
+    uploadTicket = 0;
+
+    for (ModelEntry& entry : models) {
+        entry.firstDraw = drawData.size();
+        for (Mesh& mesh : *entry.model->getMeshes()) {
+            // Base instance of the command points at this mesh's per draw data
+            unsigned int baseInstance = drawData.size();
+            drawData.push_back({entry.transform, mesh.diffuseColor});
+
+            const GeometryPool::Allocation& geometry = mesh.getGeometry();
+            uploadTicket = std::max(uploadTicket, geometry.uploadTicket);
+            unsigned int binding = 0;
+            while (binding < bindings.size() && (bindings[binding].pool != &mesh.getPool() || bindings[binding].block != geometry.block))
+                binding++;
+            if (binding == bindings.size())
+                bindings.push_back({&mesh.getPool(), geometry.block, mesh.getPool().getGeneration()});
+
+            TextureGroup* group = nullptr;
+            for (TextureGroup& existing : groups) {
+                if (existing.binding == binding && existing.textures == mesh.Textures) {
+                    group = &existing;
+                    break;
+                }
+            }
+            if (!group) {
+                TextureGroup newGroup;
+                newGroup.binding = binding;
+                newGroup.textures = mesh.Textures;
+                newGroup.samplerNames = Mesh::getSamplerNames(mesh.Textures);
+                newGroup.commands = std::make_unique<DrawCommandBuffer>();
+                groups.push_back(std::move(newGroup));
+                group = &groups.back();
+            }
+
+            // Indices stay local to the mesh, base vertex offsets them to mesh's range of the pool block
+            group->commands->addCommand(geometry.indexCount, geometry.firstIndex, geometry.baseVertex, 1, baseInstance);
+        }
+    }
+
+    drawDataVbo = std::make_unique<VertexBuffer>(drawData.data(), drawData.size() * sizeof(DrawData), GL_DYNAMIC_DRAW);
+    if (!vao) {
+        vao = std::make_unique<VertexArray>();
+        vao->setFormat(DrawDataFormat::view(), DRAW_DATA_BINDING, 3, 1);
+    }
+    vao->bindVertexBuffer(DRAW_DATA_BINDING, *drawDataVbo);
+
+    dirty = false;
+}
+
+void ModelBatch::draw(Shader& shader) {
+    // Defragmenting the pool moves meshes into new buffers
+    for (const BlockBinding& binding : bindings) {
+        if (binding.generation != binding.pool->getGeneration())
+            dirty = true;
+    }
+    if (dirty)
+        build();
+    drawDataVbo->flush();
+
+    // Materials need reflection of linked program, renderer would skip the draws anyway.
+    // Multi draw covers all meshes, so it waits until every one of them is uploaded
+    if (!shader.isReady() || !UploadQueue::isComplete(uploadTicket))
+        return;
+    if (shader.getRendererID() != uniformProgram) {
+        uniformProgram = shader.getRendererID();
+        for (TextureGroup& group : groups) {
+            group.material = Material(shader);
+            for (unsigned int i = 0; i < group.samplerNames.size(); i++)
+                group.material.set(group.samplerNames[i], static_cast<int>(i));
+        }
+    }
+
+    Renderer renderer;
+    drawCallCount = 0;
+    for (TextureGroup& group : groups) {
+        for (unsigned int i = 0; i < group.textures.size(); i++)
+            group.textures[i]->bind(i);
+        // Groups usually bind textures to same slots, so program mostly holds right values already
+        group.material.apply();
+
+        const BlockBinding& binding = bindings[group.binding];
+        const std::vector<VertexFormatView>& streams = binding.pool->getStreams();
+        if (vaoFormat != binding.pool->getHash()) {
+            vaoFormat = binding.pool->getHash();
+            vao->setFormats(streams);
+        }
+        for (unsigned int stream = 0; stream < streams.size(); stream++)
+            vao->bindVertexBuffer(stream, binding.pool->getVertexBuffer(binding.block, stream));
+        renderer.drawIndirect(*vao, binding.pool->getIndexBuffer(binding.block), shader, *group.commands);
+        drawCallCount++;
+    }
+}
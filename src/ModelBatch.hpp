@@ -0,0 +1,85 @@
+#ifndef __ModelBatch__
+#define __ModelBatch__
+
+#include <vector>
+#include <memory>
+
+#include "glm/glm.hpp"
+#include "VertexArray.hpp"
+#include "IndexBuffer.hpp"
+#include "DrawCommandBuffer.hpp"
+#include "GeometryPool.hpp"
+#include "Material.hpp"
+
+class Model;
+class Shader;
+class Texture;
+
+// Draws meshes of one or more models straight out of their GeometryPool blocks,
+// with one glMultiDrawElementsIndirect per pool block and texture set (usually just one).
+// Per draw data (model transform and diffuse color) is stored in instanced vertex attributes
+// at locations 3-7 and is selected by base instance of each command, see modelsIndirect.glsl
+class ModelBatch {
+    public:
+        ModelBatch();
+
+        // Model must outlive the batch, returns index of the model used for setTransform()
+        unsigned int add(Model& model, const glm::mat4& transform = glm::mat4(1.0f));
+        void setTransform(unsigned int modelIndex, const glm::mat4& transform);
+
+        void draw(Shader& shader);
+
+        // Multi draw calls issued by last draw(), compared to mesh count shows saved draw calls
+        inline unsigned int getDrawCallCount() const { return drawCallCount; }
+        unsigned int getMeshCount() const;
+    private:
+        struct DrawData {
+            glm::mat4 model;
+            glm::vec4 diffuseColor;
+        };
+        // Instanced attributes, model matrix takes locations 3-6
+        using DrawDataFormat = VertexFormat<DrawData, VERTEX_MEMBER(DrawData, model), VERTEX_MEMBER(DrawData, diffuseColor)>;
+
+        struct ModelEntry {
+            Model* model;
+            glm::mat4 transform;
+            unsigned int firstDraw; ///< Index of first mesh of this model in drawData
+        };
+
+        // Pool block whose vertex buffer gets bound to binding point 0 of batch's VAO
+        struct BlockBinding {
+            GeometryPool* pool;
+            unsigned int block;
+            unsigned int generation; ///< Pool generation commands were built for
+        };
+
+        // Meshes of same block with same textures are drawn by one multi draw command
+        struct TextureGroup {
+            unsigned int binding; ///< Index into bindings
+            std::vector<Texture*> textures;
+            std::vector<std::string> samplerNames;
+            Material material; ///< Samplers, for uniformProgram
+            std::unique_ptr<DrawCommandBuffer> commands;
+        };
+
+        std::vector<ModelEntry> models;
+        std::vector<DrawData> drawData;
+        std::vector<BlockBinding> bindings;
+        std::vector<TextureGroup> groups;
+
+        std::unique_ptr<VertexBuffer> drawDataVbo;
+        // Mesh streams on first binding points, switched between blocks, per draw data on DRAW_DATA_BINDING.
+        // Meshes of one batch can come from pools of different formats, VAO then gets streams of the last pool drawn
+        static const unsigned int DRAW_DATA_BINDING = 4;
+        std::unique_ptr<VertexArray> vao;
+        uint64_t vaoFormat; ///< Hash of pool streams set on the VAO
+        unsigned int uniformProgram; ///< Program materials of groups were built for, 0 after build
+        uint64_t uploadTicket; ///< Latest upload of any batched mesh, nothing is drawn until it completes
+
+        bool dirty;
+        unsigned int drawCallCount;
+
+        void build();
+};
+
+#endif // __ModelBatch__
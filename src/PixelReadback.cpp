@@ -0,0 +1,81 @@
+#include "PixelReadback.hpp"
+
+#include "Renderer.hpp"
+#include "GLState.hpp"
+
+#include <cstring>
+
+PixelReadback::PixelReadback(int width, int height, unsigned int ringSize)
+    : width(width), height(height), slots(ringSize), next(0), oldest(0), pendingCount(0) {
+    for (Slot& slot : slots) {
+        slot.fence = nullptr;
+        slot.tag = 0;
+        GLCall(glGenBuffers(1, &slot.pbo));
+        GLState::bindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+        // Read by CPU, written by GL
+        GLCall(glBufferData(GL_PIXEL_PACK_BUFFER, width * height * 4, nullptr, GL_STREAM_READ));
+    }
+    GLState::bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
+
+PixelReadback::~PixelReadback() {
+    for (Slot& slot : slots) {
+        if (slot.fence) {
+            GLCall(glDeleteSync(slot.fence));
+        }
+        GLState::onBufferDeleted(slot.pbo);
+        GLCall(glDeleteBuffers(1, &slot.pbo));
+    }
+}
+
+bool PixelReadback::request(unsigned int tag) {
+    if (pendingCount == slots.size())
+        return false;
+
+    Slot& slot = slots[next];
+    slot.tag = tag;
+    GLCall(glBindFramebuffer(GL_READ_FRAMEBUFFER, 0));
+    GLState::bindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+    GLCall(glPixelStorei(GL_PACK_ALIGNMENT, 4));
+    // With pack buffer bound, last parameter is offset into it and call doesn't wait for GPU
+    GLCall(glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr));
+    GLState::bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    GLCall(slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+
+    next = (next + 1) % slots.size();
+    pendingCount++;
+    return true;
+}
+
+bool PixelReadback::poll(Image& image, unsigned int& tag, bool wait) {
+    if (pendingCount == 0)
+        return false;
+
+    Slot& slot = slots[oldest];
+    GLbitfield flags = wait ? GL_SYNC_FLUSH_COMMANDS_BIT : 0;
+    GLuint64 timeout = wait ? 1000000000ull : 0; // 1 second
+    GLCall(GLenum status = glClientWaitSync(slot.fence, flags, timeout));
+    if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+        return false;
+
+    GLCall(glDeleteSync(slot.fence));
+    slot.fence = nullptr;
+
+    image = Image(width, height);
+    size_t rowSize = width * 4;
+    GLState::bindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+    GLCall(const unsigned char* data = static_cast<const unsigned char*>(
+                glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, rowSize * height, GL_MAP_READ_BIT)));
+    if (data) {
+        // GL rows start at the bottom, image rows at the top
+        for (int y = 0; y < height; y++)
+            std::memcpy(image.getPixels() + y * rowSize, data + (height - 1 - y) * rowSize, rowSize);
+        GLCall(glUnmapBuffer(GL_PIXEL_PACK_BUFFER));
+    }
+    GLState::bindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    tag = slot.tag;
+    oldest = (oldest + 1) % slots.size();
+    pendingCount--;
+    return data != nullptr;
+}
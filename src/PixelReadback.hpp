@@ -0,0 +1,41 @@
+#ifndef __PixelReadback__
+#define __PixelReadback__
+
+#include <GL/glew.h>
+#include <vector>
+
+#include "Image.hpp"
+
+// Asynchronous readback of default framebuffer. glReadPixels copies into next pixel pack buffer of the ring
+// and returns immediately, data is mapped only once fence says copy finished, so reading back never stalls
+// rendering of following frames
+class PixelReadback {
+    public:
+        PixelReadback(int width, int height, unsigned int ringSize = 3);
+        ~PixelReadback();
+
+        PixelReadback(const PixelReadback&) = delete;
+        PixelReadback& operator=(const PixelReadback&) = delete;
+
+        // Starts copy of the current back buffer, tag identifies the frame when result is polled.
+        // Returns false if all buffers of the ring are still waiting to be polled
+        bool request(unsigned int tag);
+        // Copies out oldest finished readback, with wait set, blocks until it is finished
+        bool poll(Image& image, unsigned int& tag, bool wait = false);
+        bool hasPending() const { return pendingCount > 0; }
+    private:
+        struct Slot {
+            unsigned int pbo;
+            GLsync fence;
+            unsigned int tag;
+        };
+
+        int width;
+        int height;
+        std::vector<Slot> slots;
+        unsigned int next;   ///< Slot used by next request
+        unsigned int oldest; ///< Slot returned by next poll
+        unsigned int pendingCount;
+};
+
+#endif // __PixelReadback__
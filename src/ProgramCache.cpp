@@ -0,0 +1,190 @@
+#include "ProgramCache.hpp"
+
+#include "Renderer.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+namespace {
+    const uint32_t FILE_MAGIC = 0x4E494250; // "PBIN"
+
+    // Stored in front of binary data
+    struct FileHeader {
+        uint32_t magic;
+        uint32_t format;
+        uint32_t length;
+    };
+
+    struct State {
+        bool enabled = false;
+        std::string directory;
+        std::string driver; ///< Vendor, renderer and version, part of every key
+        std::vector<GLint> formats; ///< GL_PROGRAM_BINARY_FORMATS, binary in any other format is not passed to driver
+        unsigned int loaded = 0;
+        unsigned int compiled = 0;
+        unsigned int rejected = 0;
+    };
+
+    State& state() {
+        static State s;
+        return s;
+    }
+
+    // FNV-1a, continued from hash
+    uint64_t hashString(uint64_t hash, const std::string& text) {
+        for (char c : text)
+            hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ull;
+        // Separator, so {"ab", "c"} and {"a", "bc"} differ
+        return (hash ^ 0xFF) * 1099511628211ull;
+    }
+
+    std::string getPath(uint64_t key) {
+        char name[32];
+        std::snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(key));
+        return state().directory + "/" + name;
+    }
+
+    std::string getString(GLenum name) {
+        GLCall(const GLubyte* value = glGetString(name));
+        return value ? reinterpret_cast<const char*>(value) : "";
+    }
+}
+
+void ProgramCache::init(const std::string& directory) {
+    State& s = state();
+    s.enabled = false;
+    if (directory.empty())
+        return;
+    if (!GLEW_ARB_get_program_binary) {
+        std::cout << "ARB_get_program_binary not supported, program binary cache disabled\n";
+        return;
+    }
+    GLint formats = 0;
+    GLCall(glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats));
+    if (formats == 0) {
+        std::cout << "Driver supports no program binary formats, program binary cache disabled\n";
+        return;
+    }
+    s.formats.resize(formats);
+    GLCall(glGetIntegerv(GL_PROGRAM_BINARY_FORMATS, s.formats.data()));
+
+    // Fails if directory already exists, which is fine
+#ifdef _WIN32
+    _mkdir(directory.c_str());
+#else
+    mkdir(directory.c_str(), 0755);
+#endif
+    s.directory = directory;
+    s.driver = getString(GL_VENDOR) + "|" + getString(GL_RENDERER) + "|" + getString(GL_VERSION);
+    s.enabled = true;
+}
+
+bool ProgramCache::isEnabled() {
+    return state().enabled;
+}
+
+uint64_t ProgramCache::makeKey(const std::vector<std::string>& sources, const std::string& defines) {
+    uint64_t hash = 14695981039346656037ull;
+    hash = hashString(hash, state().driver);
+    hash = hashString(hash, defines);
+    for (const std::string& source : sources)
+        hash = hashString(hash, source);
+    return hash;
+}
+
+unsigned int ProgramCache::load(uint64_t key, bool separable) {
+    State& s = state();
+    if (!s.enabled)
+        return 0;
+
+    std::string path = getPath(key);
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open())
+        return 0;
+    FileHeader header;
+    std::vector<char> binary;
+    if (file.read(reinterpret_cast<char*>(&header), sizeof(header)) && header.magic == FILE_MAGIC) {
+        binary.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+    file.close();
+
+    // Format of other driver (e.g. cache directory copied between machines) can't be loaded, some drivers crash on it
+    bool supported = std::find(s.formats.begin(), s.formats.end(), static_cast<GLint>(header.format)) != s.formats.end();
+
+    unsigned int program = 0;
+    GLint linked = GL_FALSE;
+    if (supported && !binary.empty() && binary.size() == header.length) {
+        GLCall(program = glCreateProgram());
+        if (separable) {
+            GLCall(glProgramParameteri(program, GL_PROGRAM_SEPARABLE, GL_TRUE));
+        }
+        GLCall(glProgramBinary(program, header.format, binary.data(), header.length));
+        GLCall(glGetProgramiv(program, GL_LINK_STATUS, &linked));
+    }
+    if (linked == GL_FALSE) {
+        // Truncated file, unsupported format or binary driver no longer accepts, next compile stores a fresh one
+        std::cout << "Program binary " << path << " rejected, compiling from source\n";
+        if (program) {
+            GLCall(glDeleteProgram(program));
+        }
+        std::remove(path.c_str());
+        s.rejected++;
+        return 0;
+    }
+    s.loaded++;
+    return program;
+}
+
+void ProgramCache::prepare(unsigned int program) {
+    if (state().enabled) {
+        GLCall(glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE));
+    }
+}
+
+void ProgramCache::store(uint64_t key, unsigned int program) {
+    if (!state().enabled)
+        return;
+
+    GLint length = 0;
+    GLCall(glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length));
+    if (length <= 0)
+        return;
+    std::vector<char> binary(length);
+    FileHeader header = {FILE_MAGIC, 0, 0};
+    GLCall(glGetProgramBinary(program, length, &length, &header.format, binary.data()));
+    header.length = length;
+
+    std::string path = getPath(key);
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        std::cout << "Could not write program binary " << path << "\n";
+        return;
+    }
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(binary.data(), length);
+}
+
+unsigned int ProgramCache::getLoadedCount() {
+    return state().loaded;
+}
+
+unsigned int ProgramCache::getCompiledCount() {
+    return state().compiled;
+}
+
+unsigned int ProgramCache::getRejectedCount() {
+    return state().rejected;
+}
+
+void ProgramCache::onCompiled() {
+    state().compiled++;
+}
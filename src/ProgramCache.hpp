@@ -0,0 +1,39 @@
+#ifndef __ProgramCache__
+#define __ProgramCache__
+
+#include <GL/glew.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// On disk cache of linked programs (glGetProgramBinary), so creating a shader again, in this or later run,
+// skips compiling and linking. Binaries are keyed by hash of all sources, defines and driver (GL_VENDOR,
+// GL_RENDERER, GL_VERSION), one file per program in cache directory. Driver may still reject a binary
+// (e.g. after update without version change), it is then deleted and program compiled as usual.
+// Without ARB_get_program_binary or any supported binary format cache stays disabled
+class ProgramCache {
+    public:
+        // Called once after context is created, empty directory disables the cache
+        static void init(const std::string& directory = "shader_cache");
+        static bool isEnabled();
+
+        static uint64_t makeKey(const std::vector<std::string>& sources, const std::string& defines = "");
+
+        // Returns linked program created from stored binary, or 0 if there is none or driver rejected it.
+        // Separable programs (single pipeline stage) must say so, as flag has to be set before the binary is loaded
+        static unsigned int load(uint64_t key, bool separable = false);
+        // Must be called before glLinkProgram, so driver keeps binary around for store()
+        static void prepare(unsigned int program);
+        // Program must be linked successfully
+        static void store(uint64_t key, unsigned int program);
+
+        // Counted since start, programs loaded from cache, compiled from source and binaries rejected by driver
+        static unsigned int getLoadedCount();
+        static unsigned int getCompiledCount();
+        static unsigned int getRejectedCount();
+        // Shader reports every program it had to compile from source
+        static void onCompiled();
+};
+
+#endif // __ProgramCache__
@@ -0,0 +1,107 @@
+#include "RenderQueue.hpp"
+
+#include "Renderer.hpp"
+#include "Texture.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+// Bit pattern of positive float grows together with its value, so upper 24 bits
+// can be used as quantized depth without knowing near and far planes
+static uint64_t quantizeDepth(float depth) {
+    if (!(depth > 0.0f))
+        return 0;
+    uint32_t bits;
+    std::memcpy(&bits, &depth, sizeof(bits));
+    return (bits >> 7) & 0xFFFFFF;
+}
+
+uint64_t RenderQueue::makeSortKey(const RenderCommand& command) {
+    uint64_t pass = static_cast<uint64_t>(command.pass) & 0x3;
+    uint64_t program = command.shader->getRendererID() & 0x3FF;
+    uint64_t vao = command.va->getRendererID() & 0xFFF;
+
+    uint64_t textures = 0;
+    for (unsigned int i = 0; i < MAX_COMMAND_TEXTURES; i++) {
+        if (command.textures[i])
+            textures = textures * 31 + command.textures[i]->getID() + 1;
+    }
+    textures &= 0xFFFF;
+
+    uint64_t depth = quantizeDepth(command.depth);
+
+    if (command.pass == RenderPass::OPAQUE_PASS) {
+        return (pass << 62) | (program << 52) | (textures << 36) | (vao << 24) | depth;
+    }
+    // Farthest objects must come first for blending to work
+    return (pass << 62) | ((0xFFFFFF - depth) << 38) | (program << 28) | (textures << 12) | vao;
+}
+
+void RenderQueue::submit(const RenderCommand& command) {
+    commands.push_back(command);
+}
+
+void RenderQueue::execute() {
+    entries.clear();
+    for (unsigned int i = 0; i < commands.size(); i++) {
+        entries.push_back({makeSortKey(commands[i]), i});
+    }
+    // Index as a tie breaker keeps submission order for commands with equal keys
+    std::sort(entries.begin(), entries.end(), [](const SortEntry& a, const SortEntry& b) {
+        return a.key < b.key || (a.key == b.key && a.index < b.index);
+    });
+
+    programSwitches = 0;
+    textureSwitches = 0;
+    const Shader* currentShader = nullptr;
+    const Texture* currentTextures[MAX_COMMAND_TEXTURES] = {nullptr, nullptr, nullptr, nullptr};
+    bool depthWritesDisabled = false;
+
+    for (const SortEntry& entry : entries) {
+        RenderCommand& command = commands[entry.index];
+        if (!command.shader->isReady() || !command.ib->isResident())
+            continue;
+
+        // Transparent and overlay geometry is tested against depth buffer, but must not write to it
+        if (command.pass != RenderPass::OPAQUE_PASS && !depthWritesDisabled) {
+            GLCall(glDepthMask(GL_FALSE));
+            depthWritesDisabled = true;
+        }
+
+        if (command.shader != currentShader) {
+            command.shader->bind();
+            currentShader = command.shader;
+            programSwitches++;
+        }
+
+        for (unsigned int slot = 0; slot < MAX_COMMAND_TEXTURES; slot++) {
+            if (command.textures[slot] && command.textures[slot] != currentTextures[slot]) {
+                command.textures[slot]->bind(slot);
+                currentTextures[slot] = command.textures[slot];
+                textureSwitches++;
+            }
+        }
+
+        if (command.modelUniform.isValid())
+            command.modelUniform.set(command.model);
+
+        command.va->bind();
+        command.ib->bind();
+        if (command.instanceCount > 0) {
+            GLCall(glDrawElementsInstanced(command.ib->getMode(), command.ib->getCount(), command.ib->getType(), nullptr, command.instanceCount));
+        } else {
+            GLCall(glDrawElements(command.ib->getMode(), command.ib->getCount(), command.ib->getType(), nullptr));
+        }
+    }
+
+    if (depthWritesDisabled) {
+        GLCall(glDepthMask(GL_TRUE));
+    }
+
+    commands.clear();
+}
+
+void RenderQueue::clear() {
+    commands.clear();
+    entries.clear();
+}
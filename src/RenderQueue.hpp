@@ -0,0 +1,76 @@
+#ifndef __RenderQueue__
+#define __RenderQueue__
+
+#include <vector>
+#include <cstdint>
+
+#include "glm/glm.hpp"
+#include "Uniform.hpp"
+
+class VertexArray;
+class IndexBuffer;
+class Shader;
+class Texture;
+
+// Passes are executed in this order, value ends up in the top bits of the sort key
+enum class RenderPass {
+    OPAQUE_PASS = 0,
+    TRANSPARENT_PASS = 1,
+    OVERLAY_PASS = 2
+};
+
+const unsigned int MAX_COMMAND_TEXTURES = 4;
+
+// Everything needed to issue one draw later, uniforms which differ per draw must be
+// stored here too, because by the time command executes, shader state will have changed
+struct RenderCommand {
+    const VertexArray* va = nullptr;
+    const IndexBuffer* ib = nullptr;
+    Shader* shader = nullptr;
+    // Texture at index i will be bound to slot i, nullptr slots are skipped
+    const Texture* textures[MAX_COMMAND_TEXTURES] = {nullptr, nullptr, nullptr, nullptr};
+    unsigned int instanceCount = 0; ///< 0 means non instanced draw
+
+    glm::mat4 model = glm::mat4(1.0f);
+    Uniform<glm::mat4> modelUniform; ///< If valid, model matrix is uploaded to this uniform of shader before draw
+
+    float depth = 0.0f; ///< Distance from camera, used for ordering within the pass
+    RenderPass pass = RenderPass::OPAQUE_PASS;
+};
+
+// Deferred draw queue: commands are collected during the frame, sorted once by 64 bit key and
+// then executed in key order.
+//
+// Opaque key:      | pass 2 | program 10 | textures 16 | vao 12 | depth 24 |
+// Transparent key: | pass 2 | inverted depth 24 | program 10 | textures 16 | vao 12 |
+//
+// So opaque geometry is grouped by state to minimise program and texture switches (and drawn front to back
+// inside same state), while transparent geometry is always drawn back to front
+class RenderQueue {
+    public:
+        void submit(const RenderCommand& command);
+        // Sort and execute all queued commands, queue is empty afterwards
+        void execute();
+        void clear();
+
+        inline unsigned int size() const { return commands.size(); }
+        // Stats of the last execute() call
+        inline unsigned int getProgramSwitches() const { return programSwitches; }
+        inline unsigned int getTextureSwitches() const { return textureSwitches; }
+
+        static uint64_t makeSortKey(const RenderCommand& command);
+    private:
+        struct SortEntry {
+            uint64_t key;
+            unsigned int index;
+        };
+
+        // Storage is reused between frames, so after first frame submitting does not allocate
+        std::vector<RenderCommand> commands;
+        std::vector<SortEntry> entries;
+
+        unsigned int programSwitches = 0;
+        unsigned int textureSwitches = 0;
+};
+
+#endif // __RenderQueue__
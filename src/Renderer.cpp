@@ -1,20 +1,11 @@
 #include "Renderer.hpp"
 
 #include <iostream>
-
-void GLClearError() {
-    while(glGetError() != GL_NO_ERROR);
-}
-
-bool GLLogCall(const char* func, const char* file, int line) {
-    while(GLenum error = glGetError()) {
-        std::cout << "[OpenGL Error] " << "(" << error << "): " << func << " " << file << ":" << line << std::endl;
-        return false;
-    }
-    return true;
-}
+#include <cstdint>
 
 void Renderer::draw(const VertexArray& va, const IndexBuffer& ib, const Shader& shader) const {
+    if (!shader.isReady() || !ib.isResident())
+        return;
     shader.bind();
 
     // By using vertex array obbject, we dont need to bind array buffer and vertex attributes 2nd time
@@ -22,10 +13,12 @@ void Renderer::draw(const VertexArray& va, const IndexBuffer& ib, const Shader&
     ib.bind();
 
     // Needs index buffer object, but this way we save memory and vertex data is smaller
-    GLCall(glDrawElements(GL_TRIANGLES, ib.getCount(), GL_UNSIGNED_INT, nullptr));
+    GLCall(glDrawElements(ib.getMode(), ib.getCount(), ib.getType(), nullptr));
 }
 
 void Renderer::drawInstanced(const VertexArray& va, const IndexBuffer& ib, const Shader& shader, unsigned int instanceCount) const {
+    if (!shader.isReady() || !ib.isResident())
+        return;
     shader.bind();
 
     // By using vertex array obbject, we dont need to bind array buffer and vertex attributes 2nd time
@@ -33,7 +26,109 @@ void Renderer::drawInstanced(const VertexArray& va, const IndexBuffer& ib, const
     ib.bind();
 
     // Needs index buffer object, but this way we save memory and vertex data is smaller
-    GLCall(glDrawElementsInstanced(GL_TRIANGLES, ib.getCount(), GL_UNSIGNED_INT, nullptr, instanceCount));
+    GLCall(glDrawElementsInstanced(ib.getMode(), ib.getCount(), ib.getType(), nullptr, instanceCount));
+}
+
+void Renderer::drawBaseVertex(const VertexArray& va, const IndexBuffer& ib, const Shader& shader, unsigned int indexCount,
+        int baseVertex, unsigned int firstIndex) const {
+    if (!shader.isReady() || !ib.isResident())
+        return;
+    shader.bind();
+    va.bind();
+    ib.bind();
+
+    const void* indices = (const void*)(uintptr_t)(firstIndex * ib.getTypeSize());
+    GLCall(glDrawElementsBaseVertex(ib.getMode(), indexCount, ib.getType(), indices, baseVertex));
+}
+
+void Renderer::drawInstancedBaseVertex(const VertexArray& va, const IndexBuffer& ib, const Shader& shader, unsigned int indexCount,
+        int baseVertex, unsigned int instanceCount, unsigned int firstIndex) const {
+    if (!shader.isReady() || !ib.isResident())
+        return;
+    shader.bind();
+    va.bind();
+    ib.bind();
+
+    const void* indices = (const void*)(uintptr_t)(firstIndex * ib.getTypeSize());
+    GLCall(glDrawElementsInstancedBaseVertex(ib.getMode(), indexCount, ib.getType(), indices, instanceCount, baseVertex));
+}
+
+void Renderer::drawIndirect(const VertexArray& va, const IndexBuffer& ib, const Shader& shader, DrawCommandBuffer& commands) const {
+    if (commands.getCommandCount() == 0)
+        return;
+
+    if (!shader.isReady() || !ib.isResident())
+        return;
+    shader.bind();
+    va.bind();
+    ib.bind();
+
+    if (GLEW_ARB_multi_draw_indirect) {
+        commands.upload();
+        commands.bind();
+        GLCall(glMultiDrawElementsIndirect(ib.getMode(), ib.getType(), nullptr, commands.getCommandCount(), 0));
+        return;
+    }
+
+    // Fallback for pre 4.3 contexts, without base instance per draw data can not be fetched correctly
+    static bool warned = false;
+    if (!GLEW_ARB_base_instance && !warned) {
+        std::cout << "ARB_base_instance not supported, per draw data of indirect draws will be wrong\n";
+        warned = true;
+    }
+    for (const DrawElementsIndirectCommand& command : commands.getCommands()) {
+        const void* indices = (const void*)(uintptr_t)(command.firstIndex * ib.getTypeSize());
+        if (GLEW_ARB_base_instance) {
+            GLCall(glDrawElementsInstancedBaseVertexBaseInstance(ib.getMode(), command.count, ib.getType(), indices,
+                        command.instanceCount, command.baseVertex, command.baseInstance));
+        } else {
+            GLCall(glDrawElementsInstancedBaseVertex(ib.getMode(), command.count, ib.getType(), indices,
+                        command.instanceCount, command.baseVertex));
+        }
+    }
+}
+
+void Renderer::submit(const RenderCommand& command) const {
+    getQueue().submit(command);
+}
+
+void Renderer::flush() const {
+    getQueue().execute();
+}
+
+RenderQueue& Renderer::getQueue() {
+    static RenderQueue queue;
+    return queue;
+}
+
+std::map<uint64_t, std::unique_ptr<VertexArray>>& Renderer::getVertexArrays() {
+    static std::map<uint64_t, std::unique_ptr<VertexArray>> vertexArrays;
+    return vertexArrays;
+}
+
+VertexArray& Renderer::getVertexArray(const VertexFormatView& format) {
+    // Called for every pooled mesh draw, so hit doesn't build stream list
+    auto& vertexArrays = getVertexArrays();
+    auto it = vertexArrays.find(format.hash);
+    if (it != vertexArrays.end())
+        return *it->second;
+    return getVertexArray(std::vector<VertexFormatView>{format});
+}
+
+VertexArray& Renderer::getVertexArray(const std::vector<VertexFormatView>& streams) {
+    auto& vertexArrays = getVertexArrays();
+    uint64_t hash = hashVertexStreams(streams);
+    auto it = vertexArrays.find(hash);
+    if (it == vertexArrays.end()) {
+        std::unique_ptr<VertexArray> va = std::make_unique<VertexArray>();
+        va->setFormats(streams);
+        it = vertexArrays.insert({hash, std::move(va)}).first;
+    }
+    return *it->second;
+}
+
+void Renderer::clearVertexArrayCache() {
+    getVertexArrays().clear();
 }
 
 void Renderer::clear() const {
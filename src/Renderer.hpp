@@ -3,26 +3,31 @@
 
 #include <GL/glew.h>
 
+#include <map>
+#include <memory>
+
 #include "VertexArray.hpp"
 #include "IndexBuffer.hpp"
 #include "Shader.hpp"
+#include "RenderQueue.hpp"
+#include "GLDebug.hpp"
+#include "DrawCommandBuffer.hpp"
 
 
-// In Vigilant, these Macros below will only, if at all, will be used for debug builds only
-//#ifdef DEBUG
-    //#define GLCall(x) GLClearError(); x; ASSERT(GLLogCall(...))
-//#else
-    //#define GLCall(x) x
-//#endif
-//Also these macros would go to error handler classes
-
 // raise() is POSIX system specific
 // could not use _debugbreak() because it's MVSC specific
 #include <signal.h>
 #define ASSERT(x) if(!(x)) raise(SIGABRT)
-#define GLCall(x) GLClearError();\
+
+// Error checking is compiled in for debug builds only, release builds issue bare calls
+// and can additionally request KHR_no_error context (GL_NO_ERROR_CONTEXT)
+#ifdef DEBUG
+#define GLCall(x) GLDebug::beginCall(#x, __FILE__, __LINE__);\
     x;\
-    ASSERT(GLLogCall(#x, __FILE__, __LINE__))
+    ASSERT(GLDebug::endCall())
+#else
+#define GLCall(x) x
+#endif
 
 void GLClearError();
 bool GLLogCall(const char* func, const char* file, int line);
@@ -31,9 +36,34 @@ bool GLLogCall(const char* func, const char* file, int line);
 class Renderer {
     public:
         void clear() const;
+        // Draws are skipped while shader is still compiling (see Shader::isReady()) or indices are not uploaded yet
+        // Index type and mode (triangle list or strips) are taken from ib
         void draw(const VertexArray& va, const IndexBuffer& ib, const Shader& shader) const;
         void drawInstanced(const VertexArray& va, const IndexBuffer& ib, const Shader& shader, unsigned int instanceCount) const;
+        // Draws indexCount indices starting at firstIndex, each offset by baseVertex,
+        // e.g. to select region of a StreamBuffer or mesh inside a GeometryPool
+        void drawBaseVertex(const VertexArray& va, const IndexBuffer& ib, const Shader& shader, unsigned int indexCount,
+                int baseVertex, unsigned int firstIndex = 0) const;
+        void drawInstancedBaseVertex(const VertexArray& va, const IndexBuffer& ib, const Shader& shader, unsigned int indexCount,
+                int baseVertex, unsigned int instanceCount, unsigned int firstIndex = 0) const;
+        // Issues all commands with one glMultiDrawElementsIndirect, va and ib must contain geometry of every command
+        void drawIndirect(const VertexArray& va, const IndexBuffer& ib, const Shader& shader, DrawCommandBuffer& commands) const;
+
+        // Deferred drawing: commands are sorted by state and depth and only issued on flush()
+        void submit(const RenderCommand& command) const;
+        void flush() const;
+
+        // Queue is shared by all renderers, so its storage survives Renderer objects created every frame
+        static RenderQueue& getQueue();
+        // One VAO per vertex format (keyed by its hash) with the format set on binding point 0, shared by every
+        // buffer of that format, which is switched in with bindVertexBuffer(0, ...) before drawing.
+        // Cache must be cleared with clearVertexArrayCache() while context exists
+        static VertexArray& getVertexArray(const VertexFormatView& format);
+        // Same for split streams, stream i set on binding point i (see VertexArray::setFormats())
+        static VertexArray& getVertexArray(const std::vector<VertexFormatView>& streams);
+        static void clearVertexArrayCache();
     private:
+        static std::map<uint64_t, std::unique_ptr<VertexArray>>& getVertexArrays();
 };
 
 #endif // __Renderer__
@@ -5,58 +5,298 @@
 #include <sstream>
 
 #include "Renderer.hpp"
+#include "GLState.hpp"
+#include "CPUProfiler.hpp"
+#include "ProgramCache.hpp"
+#include "FrameUniforms.hpp"
+#include "ShaderPreprocessor.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+    struct State {
+        bool parallelCompile = false;
+        bool separablePrograms = false;
+        std::vector<const Shader*> compiling; ///< Programs submitted but not finished yet
+        // Separable stages by key of their source, alive as long as some pipeline uses them
+        std::unordered_map<uint64_t, std::weak_ptr<const Shader>> stages;
+    };
+
+    State& state() {
+        static State s;
+        return s;
+    }
+
+    // Size of one element, 0 for types Material does not store (e.g. unsigned and double)
+    unsigned int getUniformTypeSize(GLenum type) {
+        switch (type) {
+            case GL_FLOAT:
+            case GL_INT:
+            case GL_BOOL:
+            case GL_SAMPLER_2D:
+            case GL_SAMPLER_CUBE:   return 4;
+            case GL_FLOAT_VEC2:
+            case GL_INT_VEC2:       return 8;
+            case GL_FLOAT_VEC3:
+            case GL_INT_VEC3:       return 12;
+            case GL_FLOAT_VEC4:
+            case GL_INT_VEC4:       return 16;
+            case GL_FLOAT_MAT3:     return 36;
+            case GL_FLOAT_MAT4:     return 64;
+        }
+        return 0;
+    }
 
+    // Same as glUniform* calls of Shader::uploadUniform(), but program does not need to be bound
+    void writeProgramUniform(unsigned int program, int location, GLenum type, int count, const void* value) {
+        const float* floats = static_cast<const float*>(value);
+        const int* ints = static_cast<const int*>(value);
+        switch (type) {
+            case GL_FLOAT:          GLCall(glProgramUniform1fv(program, location, count, floats)); break;
+            case GL_FLOAT_VEC2:     GLCall(glProgramUniform2fv(program, location, count, floats)); break;
+            case GL_FLOAT_VEC3:     GLCall(glProgramUniform3fv(program, location, count, floats)); break;
+            case GL_FLOAT_VEC4:     GLCall(glProgramUniform4fv(program, location, count, floats)); break;
+            case GL_FLOAT_MAT3:     GLCall(glProgramUniformMatrix3fv(program, location, count, GL_FALSE, floats)); break;
+            case GL_FLOAT_MAT4:     GLCall(glProgramUniformMatrix4fv(program, location, count, GL_FALSE, floats)); break;
+            case GL_INT_VEC2:       GLCall(glProgramUniform2iv(program, location, count, ints)); break;
+            case GL_INT_VEC3:       GLCall(glProgramUniform3iv(program, location, count, ints)); break;
+            case GL_INT_VEC4:       GLCall(glProgramUniform4iv(program, location, count, ints)); break;
+            // Scalar ints, bools and samplers
+            default:                GLCall(glProgramUniform1iv(program, location, count, ints)); break;
+        }
+    }
 
-Shader::Shader(const std::string& fileName): rendererID(0) {
+    // Returns false and prints info log if shader failed to compile
+    bool checkCompileStatus(unsigned int id) {
+        int result;
+        GLCall(glGetShaderiv(id, GL_COMPILE_STATUS, &result));
+        if (result == GL_FALSE) {
+            int length;
+            GLCall(glGetShaderiv(id, GL_INFO_LOG_LENGTH, &length));
+            std::string message(length, '\0');
+            GLCall(glGetShaderInfoLog(id, length, &length, &message[0]));
+            std::cout << "Failed to compile shader: " << message << std::endl;
+            return false;
+        }
+        return true;
+    }
+}
+
+Shader::Shader(const std::string& fileName, const std::vector<std::string>& defines) {
     ShaderProgramSource shaderSource = parseShader(fileName);
-    rendererID = createShader(shaderSource.VertexSource, shaderSource.FragmentSource);
+    shaderSource.VertexSource = ShaderPreprocessor::process(shaderSource.VertexSource, fileName, defines);
+    shaderSource.FragmentSource = ShaderPreprocessor::process(shaderSource.FragmentSource, fileName, defines);
+    rendererID = ProgramHandle(createShader(shaderSource.VertexSource, shaderSource.FragmentSource));
 }
 
-Shader::Shader(const std::string& vertexFile, const std::string& fragmentFile): rendererID(0) {
-    std::ifstream vShaderFile;
-    std::ifstream fShaderFile;
+Shader::Shader(const std::string& vertexFile, const std::string& fragmentFile, const std::vector<std::string>& defines)
+    : Shader(vertexFile, fragmentFile, defines, defines) {}
+
+Shader::Shader(const std::string& vertexFile, const std::string& fragmentFile,
+        const std::vector<std::string>& vertexDefines, const std::vector<std::string>& fragmentDefines) {
+    if (state().separablePrograms) {
+        const std::vector<std::string> extensions = {"GL_ARB_separate_shader_objects"};
+        std::vector<std::string> stageDefines = vertexDefines;
+        stageDefines.push_back("SEPARABLE_PROGRAM");
+        stages[0] = getStage(GL_VERTEX_SHADER, ShaderPreprocessor::process(ShaderPreprocessor::readFile(vertexFile),
+                    vertexFile, stageDefines, extensions));
+        stageDefines = fragmentDefines;
+        stageDefines.push_back("SEPARABLE_PROGRAM");
+        stages[1] = getStage(GL_FRAGMENT_SHADER, ShaderPreprocessor::process(ShaderPreprocessor::readFile(fragmentFile),
+                    fragmentFile, stageDefines, extensions));
+        // Stages can only be attached once linked, which finish() does
+        pipeline = ProgramPipelineHandle::create();
+        compiling = true;
+        state().compiling.push_back(this);
+        return;
+    }
 
-    vShaderFile.open(vertexFile);
-    fShaderFile.open(fragmentFile);
+    ShaderProgramSource shaderSource = {
+        ShaderPreprocessor::process(ShaderPreprocessor::readFile(vertexFile), vertexFile, vertexDefines),
+        ShaderPreprocessor::process(ShaderPreprocessor::readFile(fragmentFile), fragmentFile, fragmentDefines)
+    };
+    rendererID = ProgramHandle(createShader(shaderSource.VertexSource, shaderSource.FragmentSource));
+}
 
-    std::stringstream vShaderStream, fShaderStream;
+Shader::Shader(unsigned int type, const std::string& source) {
+    bool vertex = type == GL_VERTEX_SHADER;
+    rendererID = ProgramHandle(createShader(vertex ? source : "", vertex ? "" : source, true));
+}
 
-    vShaderStream << vShaderFile.rdbuf();
-    fShaderStream << fShaderFile.rdbuf();
+std::shared_ptr<const Shader> Shader::getStage(unsigned int type, const std::string& source) {
+    uint64_t key = ProgramCache::makeKey({source}, type == GL_VERTEX_SHADER ? "vertex" : "fragment");
+    std::weak_ptr<const Shader>& cached = state().stages[key];
+    std::shared_ptr<const Shader> stage = cached.lock();
+    if (!stage) {
+        // Constructor is private, so no make_shared
+        stage = std::shared_ptr<const Shader>(new Shader(type, source));
+        cached = stage;
+    }
+    return stage;
+}
 
-    vShaderFile.close();
-    fShaderFile.close();
+unsigned int Shader::getStageCount() {
+    unsigned int count = 0;
+    for (const auto& stage : state().stages) {
+        if (!stage.second.expired())
+            count++;
+    }
+    return count;
+}
+
+Shader::~Shader() {
+    for (const std::shared_ptr<const Shader>& stage : stages) {
+        if (stage && stage->lastWriter == this)
+            stage->lastWriter = nullptr;
+    }
+    if (compiling) {
+        std::vector<const Shader*>& pending = state().compiling;
+        pending.erase(std::find(pending.begin(), pending.end(), this));
+        GLCall(glDeleteShader(vertexID));
+        GLCall(glDeleteShader(fragmentID));
+    }
+}
 
+void Shader::init() {
+    // Let driver decide how many threads to compile on
+    if (GLEW_KHR_parallel_shader_compile) {
+        GLCall(glMaxShaderCompilerThreadsKHR(0xFFFFFFFF));
+        state().parallelCompile = true;
+    } else if (GLEW_ARB_parallel_shader_compile) {
+        GLCall(glMaxShaderCompilerThreadsARB(0xFFFFFFFF));
+        state().parallelCompile = true;
+    } else {
+        std::cout << "Parallel shader compile not supported, programs finish on first use\n";
+    }
+    state().separablePrograms = GLEW_ARB_separate_shader_objects;
+}
 
-    ShaderProgramSource shaderSource = {vShaderStream.str(), fShaderStream.str()};
-    rendererID = createShader(shaderSource.VertexSource, shaderSource.FragmentSource);
+void Shader::finishAll() {
+    // finish() removes shader from the list
+    while (!state().compiling.empty())
+        state().compiling.back()->finish();
 }
 
+unsigned int Shader::getCompilingCount() {
+    return state().compiling.size();
+}
 
-Shader::~Shader() {
-    GLCall(glDeleteProgram(rendererID));
+bool Shader::isReady() const {
+    if (compiling && isPipeline()) {
+        // Stages finish themselves, pipeline only waits for both of them
+        if (!stages[0]->isReady() || !stages[1]->isReady())
+            return false;
+    } else if (compiling && state().parallelCompile) {
+        int completed;
+        GLCall(glGetProgramiv(rendererID.get(), GL_COMPLETION_STATUS_KHR, &completed));
+        if (completed == GL_FALSE)
+            return false;
+    }
+    finish();
+    return true;
 }
 
-unsigned int Shader::createShader(const std::string& vertexShader, const std::string& fragmentShader) {
+unsigned int Shader::createShader(const std::string& vertexShader, const std::string& fragmentShader, bool separable) {
+    PROFILE_SCOPE("Shader::createShader");
 
-    GLCall(unsigned int program = glCreateProgram());
+    // Sources are preprocessed, so includes and defines are part of the key already
+    cacheKey = ProgramCache::makeKey({vertexShader, fragmentShader}, separable ? "separable" : "");
+    unsigned int program = ProgramCache::load(cacheKey, separable);
+    if (program) {
+        reflect(program);
+        FrameUniforms::bindBlocks(program, uniformBlocks);
+        return program;
+    }
 
-    unsigned int vs = compileShader(GL_VERTEX_SHADER, vertexShader);
-    unsigned int fs = compileShader(GL_FRAGMENT_SHADER, fragmentShader);
+    GLCall(program = glCreateProgram());
+    if (separable) {
+        GLCall(glProgramParameteri(program, GL_PROGRAM_SEPARABLE, GL_TRUE));
+    }
+    ProgramCache::prepare(program);
 
-    GLCall(glAttachShader(program, vs));
-    GLCall(glAttachShader(program, fs));
+    // No status queries here, they would wait for the compiler
+    if (!vertexShader.empty()) {
+        vertexID = compileShader(GL_VERTEX_SHADER, vertexShader);
+        GLCall(glAttachShader(program, vertexID));
+    }
+    if (!fragmentShader.empty()) {
+        fragmentID = compileShader(GL_FRAGMENT_SHADER, fragmentShader);
+        GLCall(glAttachShader(program, fragmentID));
+    }
     GLCall(glLinkProgram(program));
-    GLCall(glValidateProgram(program));
 
+    compiling = true;
+    state().compiling.push_back(this);
+    return program;
+}
+
+void Shader::finish() const {
+    if (!compiling)
+        return;
+    PROFILE_SCOPE("Shader::finish");
+
+    compiling = false;
+    std::vector<const Shader*>& pending = state().compiling;
+    pending.erase(std::find(pending.begin(), pending.end(), this));
+    if (isPipeline()) {
+        finishPipeline();
+        return;
+    }
+    ProgramCache::onCompiled();
+
+    unsigned int program = rendererID.get();
+    if (vertexID)
+        checkCompileStatus(vertexID);
+    if (fragmentID)
+        checkCompileStatus(fragmentID);
     // Delete intermediate shaders once they are linked to program
-    GLCall(glDeleteShader(vs));
-    GLCall(glDeleteShader(fs));
+    GLCall(glDeleteShader(vertexID));
+    GLCall(glDeleteShader(fragmentID));
+    vertexID = fragmentID = 0;
 
-    return program;
+    int result;
+    GLCall(glGetProgramiv(program, GL_LINK_STATUS, &result));
+    if (result == GL_FALSE) {
+        int length;
+        GLCall(glGetProgramiv(program, GL_INFO_LOG_LENGTH, &length));
+        std::string message(length, '\0');
+        GLCall(glGetProgramInfoLog(program, length, &length, &message[0]));
+        std::cout << "Failed to link program: " << message << std::endl;
+        return;
+    }
+    reflect(program);
+    FrameUniforms::bindBlocks(program, uniformBlocks);
+#ifdef DEBUG
+    // Expensive and depends on current state, only useful as a debugging aid
+    GLCall(glValidateProgram(program));
+#endif
+
+    ProgramCache::store(cacheKey, program);
+}
+
+void Shader::finishPipeline() const {
+    const GLbitfield stageBits[2] = {GL_VERTEX_SHADER_BIT, GL_FRAGMENT_SHADER_BIT};
+    for (int stage = 0; stage < 2; stage++) {
+        stages[stage]->finish();
+        unsigned int program = stages[stage]->rendererID.get();
+        int linked;
+        GLCall(glGetProgramiv(program, GL_LINK_STATUS, &linked));
+        // Stage already printed why it failed, pipeline just draws nothing for that stage
+        if (linked == GL_FALSE)
+            continue;
+        GLCall(glUseProgramStages(pipeline.get(), stageBits[stage], program));
+        reflect(program, stage);
+    }
+#ifdef DEBUG
+    GLCall(glValidateProgramPipeline(pipeline.get()));
+#endif
 }
 
 unsigned int Shader::compileShader(unsigned int type, const std::string& source) {
+    PROFILE_SCOPE("Shader::compileShader");
 
     GLCall(unsigned int id = glCreateShader(type));
     const char* src = source.c_str();
@@ -64,20 +304,7 @@ unsigned int Shader::compileShader(unsigned int type, const std::string& source)
     GLCall(glShaderSource(id, 1, &src, nullptr));
 
     GLCall(glCompileShader(id));
-
-    // shader error handling
-    int result;
-    GLCall(glGetShaderiv(id, GL_COMPILE_STATUS, &result));
-    if (result == GL_FALSE) {
-        int length;
-        GLCall(glGetShaderiv(id, GL_INFO_LOG_LENGTH, &length));
-        // Use alloca() to allocate error message buffer on the stack
-        char * message = (char*)alloca(length * sizeof(char));
-        GLCall(glGetShaderInfoLog(id, length, &length, message));
-        std::cout << "Failed to compile shader: " << message << std::endl;
-        GLCall(glDeleteShader(id));
-        return 0;
-    }
+    // Errors are checked in finish(), once program is linked
 
     return id;
 }
@@ -114,50 +341,221 @@ ShaderProgramSource Shader::parseShader(const std::string& fileName) {
 
 
 void Shader::bind() const {
-    GLCall(glUseProgram(rendererID));
+#ifdef DEBUG
+    // Linking in background is wasted if caller binds before program is ready, check isReady() first
+    if (!isReady())
+        std::cout << "Binding program " << getRendererID() << " waits for compiler" << std::endl;
+#endif
+    finish();
+    if (isPipeline())
+        GLState::bindProgramPipeline(pipeline.get());
+    else
+        GLState::useProgram(rendererID.get());
 }
 
 void Shader::unbind() const {
-    GLCall(glUseProgram(0));
+    GLState::useProgram(0);
 }
 
-void Shader::setUniform1i(const std::string& name, int value) {
-    GLCall(glUniform1i(getUniformLocation(name),value));
+template <typename T>
+void Shader::setNamed(UniformName name, const T& value) const {
+    const UniformSlot& slot = setByName(name);
+    if (!isPipeline()) {
+        setUniformValue(slot.location, value);
+        return;
+    }
+    for (int stage = 0; stage < 2; stage++) {
+        if (slot.stageLocations[stage] != -1)
+            setProgramUniformValue(stages[stage]->rendererID.get(), slot.stageLocations[stage], value);
+    }
+}
+
+void Shader::setUniform1i(UniformName name, int value) {
+    setNamed(name, value);
+}
+void Shader::setUniform1f(UniformName name, float value) {
+    setNamed(name, value);
+}
+
+void Shader::setUniform3f(UniformName name, float v0, float v1, float v2) {
+    setNamed(name, glm::vec3(v0, v1, v2));
 }
-void Shader::setUniform1f(const std::string& name, float value) {
-    GLCall(glUniform1f(getUniformLocation(name), value));
+
+void Shader::setUniform4f(UniformName name, float v0, float v1, float v2, float v3) {
+    setNamed(name, glm::vec4(v0, v1, v2, v3));
+}
+
+void Shader::setUniformVec3(UniformName name, const glm::vec3& vec) {
+    setNamed(name, vec);
+}
+
+void Shader::setUniformVec4(UniformName name, const glm::vec4& vec) {
+    setNamed(name, vec);
 }
 
-void Shader::setUniform3f(const std::string& name, float v0, float v1, float v2) {
-    GLCall(glUniform3f(getUniformLocation(name), v0, v1, v2));
+void Shader::setUniformMat3f(UniformName name, const glm::mat3& matrix) {
+    setNamed(name, matrix);
 }
 
-void Shader::setUniform4f(const std::string& name, float v0, float v1, float v2, float v3) {
-    GLCall(glUniform4f(getUniformLocation(name), v0, v1, v2, v3));
+void Shader::setUniformMat4f(UniformName name, const glm::mat4& matrix) {
+    setNamed(name, matrix);
 }
 
-void Shader::setUniformVec3(const std::string& name, const glm::vec3& vec) {
-    GLCall(glUniform3f(getUniformLocation(name), vec.x, vec.y, vec.z));
+const std::vector<ShaderUniform>& Shader::getUniforms() const {
+    finish();
+    return uniforms;
 }
 
-void Shader::setUniformVec4(const std::string& name, const glm::vec4& vec) {
-    GLCall(glUniform4f(getUniformLocation(name), vec.x, vec.y, vec.z, vec.w));
+const std::vector<ShaderUniformBlock>& Shader::getUniformBlocks() const {
+    finish();
+    return uniformBlocks;
 }
 
-void Shader::setUniformMat4f(const std::string& name, const glm::mat4& matrix) {
-    GLCall(glUniformMatrix4fv(getUniformLocation(name), 1, GL_FALSE, &matrix[0][0]));
+int Shader::findUniform(UniformName name) const {
+    return getUniformSlot(name).index;
 }
 
-int Shader::getUniformLocation(const std::string& name) {
-    if (uniformLocationCache.find(name) != uniformLocationCache.end()) {
-        return uniformLocationCache[name];
+unsigned int Shader::getUniformDataSize() const {
+    finish();
+    return uniformDataSize;
+}
+
+void Shader::uploadUniform(unsigned int index, const void* value) const {
+    const ShaderUniform& uniform = uniforms[index];
+    unsigned char* current = &uniformValues[uniform.offset];
+    if (uniform.size == 0)
+        return;
+    claimStages();
+    if (uniformValueKnown[index] && std::memcmp(current, value, uniform.size) == 0)
+        return;
+    std::memcpy(current, value, uniform.size);
+    uniformValueKnown[index] = true;
+
+    if (isPipeline()) {
+        writeStages(uniformSlots.at(uniform.hash), uniform.type, uniform.count, value);
+        return;
+    }
+
+    const float* floats = static_cast<const float*>(value);
+    const int* ints = static_cast<const int*>(value);
+    switch (uniform.type) {
+        case GL_FLOAT:          GLCall(glUniform1fv(uniform.location, uniform.count, floats)); break;
+        case GL_FLOAT_VEC2:     GLCall(glUniform2fv(uniform.location, uniform.count, floats)); break;
+        case GL_FLOAT_VEC3:     GLCall(glUniform3fv(uniform.location, uniform.count, floats)); break;
+        case GL_FLOAT_VEC4:     GLCall(glUniform4fv(uniform.location, uniform.count, floats)); break;
+        case GL_FLOAT_MAT3:     GLCall(glUniformMatrix3fv(uniform.location, uniform.count, GL_FALSE, floats)); break;
+        case GL_FLOAT_MAT4:     GLCall(glUniformMatrix4fv(uniform.location, uniform.count, GL_FALSE, floats)); break;
+        case GL_INT_VEC2:       GLCall(glUniform2iv(uniform.location, uniform.count, ints)); break;
+        case GL_INT_VEC3:       GLCall(glUniform3iv(uniform.location, uniform.count, ints)); break;
+        case GL_INT_VEC4:       GLCall(glUniform4iv(uniform.location, uniform.count, ints)); break;
+        // Scalar ints, bools and samplers
+        default:                GLCall(glUniform1iv(uniform.location, uniform.count, ints)); break;
+    }
+}
+
+void Shader::reflect(unsigned int program, int stage) const {
+    int count, maxLength;
+    GLCall(glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &count));
+    GLCall(glGetProgramiv(program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength));
+    std::string name(maxLength, '\0');
+    for (int i = 0; i < count; i++) {
+        int length, size;
+        GLenum type;
+        GLCall(glGetActiveUniform(program, i, maxLength, &length, &size, &type, &name[0]));
+        std::string uniform = name.substr(0, length);
+        GLCall(int location = glGetUniformLocation(program, uniform.c_str()));
+        // Uniforms inside blocks have no location
+        if (location == -1)
+            continue;
+        // Arrays are reported as "name[0]", but can be set through plain name too
+        uint64_t elementHash = hashUniformName(uniform.c_str());
+        if (uniform.size() > 3 && uniform.compare(uniform.size() - 3, 3, "[0]") == 0)
+            uniform.resize(uniform.size() - 3);
+        uint64_t hash = hashUniformName(uniform.c_str());
+
+        auto existing = uniformSlots.find(hash);
+        if (stage >= 0 && existing != uniformSlots.end()) {
+            // Fragment stage declares uniform vertex stage has too, value goes to both
+            existing->second.stageLocations[stage] = location;
+            uniformSlots[elementHash] = existing->second;
+            continue;
+        }
+        int index = uniforms.size();
+        UniformSlot slot = {stage < 0 ? location : -1, index, {-1, -1}};
+        if (stage >= 0)
+            slot.stageLocations[stage] = location;
+        uniformSlots[hash] = slot;
+        uniformSlots[elementHash] = slot;
+        unsigned int valueSize = getUniformTypeSize(type) * size;
+        uniforms.push_back({uniform, hash, type, size, location, uniformDataSize, valueSize});
+        uniformDataSize += valueSize;
+    }
+    uniformValues.assign(uniformDataSize, 0);
+    uniformValueKnown.assign(uniforms.size(), false);
+
+    GLCall(glGetProgramiv(program, GL_ACTIVE_UNIFORM_BLOCKS, &count));
+    for (int i = 0; i < count; i++) {
+        int length, dataSize;
+        GLCall(glGetActiveUniformBlockiv(program, i, GL_UNIFORM_BLOCK_NAME_LENGTH, &length));
+        GLCall(glGetActiveUniformBlockiv(program, i, GL_UNIFORM_BLOCK_DATA_SIZE, &dataSize));
+        std::string block(length, '\0');
+        GLCall(glGetActiveUniformBlockName(program, i, length, &length, &block[0]));
+        block.resize(length);
+        uniformBlocks.push_back({block, static_cast<unsigned int>(i), static_cast<unsigned int>(dataSize)});
+    }
+}
+
+const Shader::UniformSlot& Shader::getUniformSlot(UniformName name) const {
+    finish();
+    auto it = uniformSlots.find(name.hash);
+    if (it != uniformSlots.end())
+        return it->second;
+
+    // Other array elements (e.g. "lights[1]") are not listed as active uniforms
+    UniformSlot slot = {-1, -1, {-1, -1}};
+    bool found;
+    if (isPipeline()) {
+        for (int stage = 0; stage < 2; stage++) {
+            GLCall(slot.stageLocations[stage] = glGetUniformLocation(stages[stage]->rendererID.get(), name.name));
+        }
+        found = slot.stageLocations[0] != -1 || slot.stageLocations[1] != -1;
+    } else {
+        GLCall(slot.location = glGetUniformLocation(rendererID.get(), name.name));
+        found = slot.location != -1;
     }
-    GLCall(int location = glGetUniformLocation(rendererID, name.c_str()));
-    if (location == -1)
-        std::cout << "Uniform '" << name << "' doesn't exist!" << std::endl;
+    if (!found)
+        std::cout << "Uniform '" << name.name << "' doesn't exist!" << std::endl;
+
+    return uniformSlots[name.hash] = slot;
+}
 
-    uniformLocationCache[name] = location;
-    return location;
+const Shader::UniformSlot& Shader::setByName(UniformName name) const {
+    const UniformSlot& slot = getUniformSlot(name);
+    claimStages();
+    if (slot.index >= 0) {
+        uniformValueKnown[slot.index] = false;
+        appliedMaterial = 0;
+    }
+    return slot;
+}
 
+void Shader::writeStages(const UniformSlot& slot, unsigned int type, int count, const void* value) const {
+    for (int stage = 0; stage < 2; stage++) {
+        if (slot.stageLocations[stage] != -1)
+            writeProgramUniform(stages[stage]->rendererID.get(), slot.stageLocations[stage], type, count, value);
+    }
+}
+
+void Shader::claimStages() const {
+    if (!isPipeline())
+        return;
+    for (const std::shared_ptr<const Shader>& stage : stages) {
+        if (stage->lastWriter != this) {
+            // Some other pipeline sharing this stage may have changed any of its values
+            std::fill(uniformValueKnown.begin(), uniformValueKnown.end(), false);
+            appliedMaterial = 0;
+            stage->lastWriter = this;
+        }
+    }
 }
 
@@ -1,49 +1,166 @@
 #ifndef __Shader__
 #define __Shader__
 
+#include <cstdint>
+#include <memory>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "glm/glm.hpp"
+#include "GLHandle.hpp"
+#include "Uniform.hpp"
 
 struct ShaderProgramSource {
     std::string VertexSource;
     std::string FragmentSource;
 };
 
+// Uniform outside of any block, from glGetActiveUniform
+struct ShaderUniform {
+    std::string name;    ///< Arrays without "[0]"
+    uint64_t hash;       ///< hashUniformName(name), key of its slot
+    unsigned int type;   ///< GL_FLOAT_VEC3, GL_SAMPLER_2D, ...
+    int count;           ///< Array size, 1 otherwise
+    int location;
+    unsigned int offset; ///< Of its value in packed storage of all uniforms (see Material)
+    unsigned int size;   ///< Bytes of all elements, 0 for types Material can't store
+};
+
+// From glGetActiveUniformBlockiv
+struct ShaderUniformBlock {
+    std::string name;
+    unsigned int index;
+    unsigned int dataSize;
+};
 
-// This is really Shader Program, as it loads and compiles both vertex and fragment shaders
+
+// This is really Shader Program, as it loads and compiles both vertex and fragment shaders.
+// Constructor only submits compile and link, with KHR/ARB_parallel_shader_compile driver does them in background,
+// so test creating all its shaders up front does not wait for each one. Anything needing linked program
+// (bind, uniforms) waits for it, Renderer skips draws with programs which are not ready yet.
+// With ARB_separate_shader_objects separate vertex and fragment files are not linked together: each stage is
+// compiled once into separable program, shared by every Shader using same stage source, and combined with
+// the other one in program pipeline. Pairing known stage with new one therefore compiles just the new one
 class Shader {
     public:
-        Shader(const std::string& fileName);
-        Shader(const std::string& vertexFile, const std::string& fragmentFile);
+        // Sources go through ShaderPreprocessor, defines are injected after #version of every stage
+        Shader(const std::string& fileName, const std::vector<std::string>& defines = {});
+        // Pipeline of separable stages if supported (SEPARABLE_PROGRAM is defined for them), linked program otherwise
+        Shader(const std::string& vertexFile, const std::string& fragmentFile, const std::vector<std::string>& defines = {});
+        // Stage keeps being shared only with pipelines passing same defines to it
+        Shader(const std::string& vertexFile, const std::string& fragmentFile,
+                const std::vector<std::string>& vertexDefines, const std::vector<std::string>& fragmentDefines);
         ~Shader();
 
+        // Never blocks with parallel compile, finishes the program (error log, binary cache) once driver is done
+        bool isReady() const;
+
+        // Called once after context is created
+        static void init();
+        // Blocks until every submitted program is linked, e.g. before benchmark starts measuring
+        static void finishAll();
+        static unsigned int getCompilingCount();
+        // Separable stage programs alive, each shared by all pipelines using it
+        static unsigned int getStageCount();
+
 
         void bind() const;
         void unbind() const;
 
-        unsigned int getRendererID() const { return rendererID; }
+        // Program, or program pipeline for Shader made of separable stages
+        unsigned int getRendererID() const { return pipeline ? pipeline.get() : rendererID.get(); }
+        bool isPipeline() const { return static_cast<bool>(pipeline); }
 
-        // Set uniforms, TODO: use templates to have multiple types of uniforms
-        void setUniform1i(const std::string& name, int value);
-        void setUniform1f(const std::string& name, float value);
-        void setUniform3f(const std::string& name, float v0, float v1, float v2);
-        void setUniform4f(const std::string& name, float v0, float v1, float v2, float v3);
-        void setUniformVec3(const std::string& name, const glm::vec3& vec);
-        void setUniformVec4(const std::string& name, const glm::vec4& vec);
-        void setUniformMat4f(const std::string& name, const glm::mat4& matrix);
+        // Interface of linked program, reflected once it links (waits for it)
+        const std::vector<ShaderUniform>& getUniforms() const;
+        const std::vector<ShaderUniformBlock>& getUniformBlocks() const;
+        // Index into getUniforms(), -1 if there is no such uniform outside of blocks
+        int findUniform(UniformName name) const;
+        // Bytes needed to store values of all uniforms
+        unsigned int getUniformDataSize() const;
+
+        // Used by Material: uploads value of uniform at index unless program already holds it
+        void uploadUniform(unsigned int index, const void* value) const;
+        // Material which values program holds, 0 if other code set some of them since
+        uint64_t getAppliedMaterial() const { claimStages(); return appliedMaterial; }
+        void setAppliedMaterial(uint64_t material) const { appliedMaterial = material; }
+
+        // Resolve typed handle once and keep it, instead of setting uniforms by name every frame.
+        // Pipeline handle sets the uniform in vertex stage only, if both stages declare it
+        template <typename T>
+        Uniform<T> getUniform(UniformName name) const {
+            const UniformSlot& slot = getUniformSlot(name);
+            if (!isPipeline())
+                return Uniform<T>(slot.location);
+            int stage = slot.stageLocations[0] != -1 ? 0 : 1;
+            return Uniform<T>(slot.stageLocations[stage], stages[stage]->getRendererID());
+        }
+
+        // Set uniforms by name, program must be bound. Lookup is by name hash, no allocation
+        void setUniform1i(UniformName name, int value);
+        void setUniform1f(UniformName name, float value);
+        void setUniform3f(UniformName name, float v0, float v1, float v2);
+        void setUniform4f(UniformName name, float v0, float v1, float v2, float v3);
+        void setUniformVec3(UniformName name, const glm::vec3& vec);
+        void setUniformVec4(UniformName name, const glm::vec4& vec);
+        void setUniformMat3f(UniformName name, const glm::mat3& matrix);
+        void setUniformMat4f(UniformName name, const glm::mat4& matrix);
 
     private:
-        unsigned int rendererID;
-        // caching for uniforms
-        std::unordered_map<std::string, int> uniformLocationCache;
+        ProgramHandle rendererID;
+        struct UniformSlot {
+            int location;
+            int index; ///< Into uniforms, -1 for array elements and missing uniforms
+            int stageLocations[2]; ///< Pipelines only, in vertex and fragment stage program, -1 if stage lacks it
+        };
+        // Slots by name hash, every active uniform is added once program links, others when first asked for
+        mutable std::unordered_map<uint64_t, UniformSlot> uniformSlots;
+        mutable std::vector<ShaderUniform> uniforms;
+        mutable std::vector<ShaderUniformBlock> uniformBlocks;
+        mutable unsigned int uniformDataSize = 0;
+        // Values program holds, as uploaded by uploadUniform(). Setting by name makes value unknown,
+        // but handles from getUniform() must not be used for uniforms some Material sets
+        mutable std::vector<unsigned char> uniformValues;
+        mutable std::vector<bool> uniformValueKnown;
+        mutable uint64_t appliedMaterial = 0;
+
+        // Set while program is compiling, shaders are kept for their info logs until then
+        mutable bool compiling = false;
+        mutable unsigned int vertexID = 0, fragmentID = 0;
+        uint64_t cacheKey = 0;
+
+        // Pipelines only, stages are shared with other pipelines
+        ProgramPipelineHandle pipeline;
+        std::shared_ptr<const Shader> stages[2];
+        // Stages only, pipeline which wrote uniforms last, values other pipelines uploaded are unknown since
+        mutable const Shader* lastWriter = nullptr;
+
+        // Separable program with single stage
+        Shader(unsigned int type, const std::string& source);
+        // Returns existing stage with same source, or starts compiling new one
+        static std::shared_ptr<const Shader> getStage(unsigned int type, const std::string& source);
 
-        unsigned int createShader(const std::string& vertexShader, const std::string& fragmentShader);
+        // Empty source skips that stage, separable programs can be used in pipelines
+        unsigned int createShader(const std::string& vertexShader, const std::string& fragmentShader, bool separable = false);
         unsigned int compileShader(unsigned int type, const std::string& source);
+        // Waits for program if still compiling, checks compile and link status and stores binary
+        void finish() const;
+        // Attaches linked stages to pipeline and reflects them
+        void finishPipeline() const;
         ShaderProgramSource parseShader(const std::string& fileName);
 
-        int getUniformLocation(const std::string& name);
+        // Fills uniforms, blocks and slots, pipelines reflect each stage program, 0 vertex and 1 fragment
+        void reflect(unsigned int program, int stage = -1) const;
+        const UniformSlot& getUniformSlot(UniformName name) const;
+        // Setting by name bypasses uploadUniform(), so program's value becomes unknown
+        const UniformSlot& setByName(UniformName name) const;
+        template <typename T>
+        void setNamed(UniformName name, const T& value) const;
+        // Pipelines only, glProgramUniform* to each stage declaring the uniform
+        void writeStages(const UniformSlot& slot, unsigned int type, int count, const void* value) const;
+        // Pipelines only, forgets uploaded values if other pipeline wrote to shared stages since
+        void claimStages() const;
 };
 
 #endif // __Shader__
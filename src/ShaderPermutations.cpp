@@ -0,0 +1,35 @@
+#include "ShaderPermutations.hpp"
+
+ShaderPermutations::ShaderPermutations(const std::string& fileName, const std::vector<std::string>& features)
+    : vertexFile(fileName), features(features) {}
+
+ShaderPermutations::ShaderPermutations(const std::string& vertexFile, const std::string& fragmentFile,
+        const std::vector<std::string>& features)
+    : vertexFile(vertexFile), fragmentFile(fragmentFile), features(features) {}
+
+Shader& ShaderPermutations::get(uint32_t mask) {
+    // Bits without feature select nothing, so they must not make new permutation
+    if (features.size() < 32)
+        mask &= (1u << features.size()) - 1;
+
+    std::unique_ptr<Shader>& program = programs[mask];
+    if (!program) {
+        // Defines are only built once, when permutation is created
+        std::vector<std::string> defines;
+        for (unsigned int i = 0; i < features.size() && i < 32; i++) {
+            if (mask & (1u << i))
+                defines.push_back(features[i]);
+        }
+        if (fragmentFile.empty())
+            program = std::make_unique<Shader>(vertexFile, defines);
+        else
+            program = std::make_unique<Shader>(vertexFile, fragmentFile, std::vector<std::string>(), defines);
+    }
+
+    if (program->isReady()) {
+        lastReady = program.get();
+        return *program;
+    }
+    // Nothing ready yet, caller gets program which Renderer skips until it is linked
+    return lastReady ? *lastReady : *program;
+}
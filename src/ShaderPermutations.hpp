@@ -0,0 +1,35 @@
+#ifndef __ShaderPermutations__
+#define __ShaderPermutations__
+
+#include "Shader.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// One shader source specialised by feature defines instead of runtime uniform branches. Every combination
+// of features is its own program, compiled the first time it is asked for and kept by its feature mask,
+// so switching back to earlier combination is free and ProgramCache makes it free in later runs too
+class ShaderPermutations {
+    public:
+        // Feature i is enabled by bit i of the mask passed to get(), at most 32 features
+        ShaderPermutations(const std::string& fileName, const std::vector<std::string>& features);
+        // Features select fragment stage only, so with separable programs all permutations share one vertex stage
+        ShaderPermutations(const std::string& vertexFile, const std::string& fragmentFile,
+                const std::vector<std::string>& features);
+
+        // Starts compiling permutation if it doesn't exist yet. While it is still compiling last used permutation
+        // which is ready is returned instead, so toggling a feature never stalls the frame
+        Shader& get(uint32_t mask);
+
+        unsigned int getPermutationCount() const { return programs.size(); }
+    private:
+        std::string vertexFile, fragmentFile; ///< Fragment file empty for single file shaders
+        std::vector<std::string> features;
+        std::unordered_map<uint32_t, std::unique_ptr<Shader>> programs; ///< By feature mask, lookup allocates nothing
+        Shader* lastReady = nullptr;
+};
+
+#endif // __ShaderPermutations__
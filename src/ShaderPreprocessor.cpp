@@ -0,0 +1,92 @@
+#include "ShaderPreprocessor.hpp"
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace {
+    struct Context {
+        std::vector<std::string> files; ///< Index is source string number used in #line
+        const std::vector<std::string>* defines;
+        const std::vector<std::string>* extensions;
+        bool definesInjected = false;
+        std::string output;
+    };
+
+    std::string getDirectory(const std::string& path) {
+        size_t slash = path.find_last_of("/\\");
+        return slash == std::string::npos ? "" : path.substr(0, slash + 1);
+    }
+
+    // Returns true if line starts with given directive, ignoring leading whitespace
+    bool isDirective(const std::string& line, const char* directive, size_t& end) {
+        size_t start = line.find_first_not_of(" \t");
+        if (start == std::string::npos || line.compare(start, std::char_traits<char>::length(directive), directive) != 0)
+            return false;
+        end = start + std::char_traits<char>::length(directive);
+        return true;
+    }
+
+    void processFile(Context& context, const std::string& source, unsigned int fileIndex) {
+        std::istringstream stream(source);
+        std::string line;
+        unsigned int lineNumber = 0;
+        while (std::getline(stream, line)) {
+            lineNumber++;
+            size_t end;
+            if (isDirective(line, "#include", end)) {
+                size_t open = line.find('"', end);
+                size_t close = open == std::string::npos ? open : line.find('"', open + 1);
+                if (close == std::string::npos) {
+                    std::cout << context.files[fileIndex] << ":" << lineNumber << ": malformed #include\n";
+                    continue;
+                }
+                std::string path = getDirectory(context.files[fileIndex]) + line.substr(open + 1, close - open - 1);
+                bool included = false;
+                for (const std::string& file : context.files)
+                    included = included || file == path;
+                if (included)
+                    continue;
+
+                context.files.push_back(path);
+                unsigned int includedIndex = context.files.size() - 1;
+                context.output += "#line 1 " + std::to_string(includedIndex) + "\n";
+                processFile(context, ShaderPreprocessor::readFile(path), includedIndex);
+                context.output += "#line " + std::to_string(lineNumber + 1) + " " + std::to_string(fileIndex) + "\n";
+                continue;
+            }
+
+            context.output += line + "\n";
+            if (!context.definesInjected && isDirective(line, "#version", end)) {
+                // Nothing but comments may come before #version, so this is the earliest place for defines
+                for (const std::string& extension : *context.extensions)
+                    context.output += "#extension " + extension + " : require\n";
+                for (const std::string& define : *context.defines)
+                    context.output += "#define " + define + "\n";
+                context.output += "#line " + std::to_string(lineNumber + 1) + " " + std::to_string(fileIndex) + "\n";
+                context.definesInjected = true;
+            }
+        }
+    }
+}
+
+std::string ShaderPreprocessor::process(const std::string& source, const std::string& path,
+        const std::vector<std::string>& defines, const std::vector<std::string>& extensions) {
+    Context context;
+    context.files.push_back(path);
+    context.defines = &defines;
+    context.extensions = &extensions;
+    processFile(context, source, 0);
+    return context.output;
+}
+
+std::string ShaderPreprocessor::readFile(const std::string& path) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        std::cout << "Could not open shader source " << path << std::endl;
+        return "";
+    }
+    std::stringstream stream;
+    stream << file.rdbuf();
+    return stream.str();
+}
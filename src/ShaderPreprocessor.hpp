@@ -0,0 +1,22 @@
+#ifndef __ShaderPreprocessor__
+#define __ShaderPreprocessor__
+
+#include <string>
+#include <vector>
+
+// Resolves #include "file" (relative to including file, every file included once per stage) and injects
+// #define lines right after #version, so one source can be specialised at compile time instead of branching
+// on uniforms. #line directives keep compile errors pointing at the right file (source string number is
+// the order files were first included in, 0 being the main file) and line. Conditionals are left to the GLSL
+// compiler, so #include inside #if is still resolved
+class ShaderPreprocessor {
+    public:
+        // Defines are either "NAME" or "NAME value", extensions are required with #extension ahead of defines
+        static std::string process(const std::string& source, const std::string& path,
+                const std::vector<std::string>& defines = {}, const std::vector<std::string>& extensions = {});
+
+        // Contents of file, empty and error printed if it can't be read
+        static std::string readFile(const std::string& path);
+};
+
+#endif // __ShaderPreprocessor__
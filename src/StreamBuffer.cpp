@@ -0,0 +1,97 @@
+#include "StreamBuffer.hpp"
+
+#include "Renderer.hpp"
+#include "GLState.hpp"
+
+#include <iostream>
+
+StreamBuffer::StreamBuffer(GLenum target, unsigned int regionSize, bool allowPersistent)
+    : rendererID(0), target(target), regionSize(regionSize), persistentData(nullptr), currentRegion(0), stallCount(0) {
+    for (unsigned int i = 0; i < REGION_COUNT; i++)
+        fences[i] = nullptr;
+
+    mode = (allowPersistent && GLEW_ARB_buffer_storage) ? StreamBufferMode::PERSISTENT : StreamBufferMode::ORPHANING;
+
+    GLCall(glGenBuffers(1, &rendererID));
+    bind();
+    if (mode == StreamBufferMode::PERSISTENT) {
+        // Coherent mapping makes writes visible to GPU without explicit flush
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        GLCall(glBufferStorage(target, regionSize * REGION_COUNT, nullptr, flags));
+        GLCall(persistentData = glMapBufferRange(target, 0, regionSize * REGION_COUNT, flags));
+        if (!persistentData) {
+            std::cout << "Persistent mapping of stream buffer failed, falling back to orphaning\n";
+            // Immutable storage can't be respecified, so start over with a new buffer
+            GLState::onBufferDeleted(rendererID);
+            GLCall(glDeleteBuffers(1, &rendererID));
+            GLCall(glGenBuffers(1, &rendererID));
+            bind();
+            mode = StreamBufferMode::ORPHANING;
+        }
+    }
+    if (mode == StreamBufferMode::ORPHANING) {
+        GLCall(glBufferData(target, regionSize, nullptr, GL_STREAM_DRAW));
+    }
+}
+
+StreamBuffer::~StreamBuffer() {
+    for (unsigned int i = 0; i < REGION_COUNT; i++) {
+        if (fences[i]) {
+            GLCall(glDeleteSync(fences[i]));
+        }
+    }
+    if (persistentData) {
+        bind();
+        GLCall(glUnmapBuffer(target));
+    }
+    GLState::onBufferDeleted(rendererID);
+    GLCall(glDeleteBuffers(1, &rendererID));
+}
+
+void* StreamBuffer::map() {
+    if (mode == StreamBufferMode::ORPHANING) {
+        bind();
+        // Detaches old storage still used by GPU, then mapping the new one needs no synchronisation
+        GLCall(glBufferData(target, regionSize, nullptr, GL_STREAM_DRAW));
+        GLCall(void* data = glMapBufferRange(target, 0, regionSize,
+                    GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT | GL_MAP_UNSYNCHRONIZED_BIT));
+        return data;
+    }
+
+    GLsync& fence = fences[currentRegion];
+    if (fence) {
+        GLCall(GLenum status = glClientWaitSync(fence, 0, 0));
+        if (status == GL_TIMEOUT_EXPIRED) {
+            stallCount++;
+            do {
+                GLCall(status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000)); // 1ms
+            } while (status == GL_TIMEOUT_EXPIRED);
+        }
+        GLCall(glDeleteSync(fence));
+        fence = nullptr;
+    }
+    return static_cast<char*>(persistentData) + getRegionOffset();
+}
+
+void StreamBuffer::unmap() {
+    if (mode == StreamBufferMode::ORPHANING) {
+        bind();
+        GLCall(glUnmapBuffer(target));
+    }
+    // Coherent persistent mapping stays mapped, nothing to do
+}
+
+void StreamBuffer::lockRegion() {
+    if (mode == StreamBufferMode::ORPHANING)
+        return;
+    GLCall(fences[currentRegion] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+    currentRegion = (currentRegion + 1) % REGION_COUNT;
+}
+
+void StreamBuffer::bind() const {
+    GLState::bindBuffer(target, rendererID);
+}
+
+void StreamBuffer::unbind() const {
+    GLState::bindBuffer(target, 0);
+}
@@ -0,0 +1,53 @@
+#ifndef __StreamBuffer__
+#define __StreamBuffer__
+
+#include <GL/glew.h>
+
+enum class StreamBufferMode {
+    PERSISTENT, ///< glBufferStorage, mapped once, CPU writes straight into GPU visible memory
+    ORPHANING   ///< glBufferData(nullptr) every frame, driver hands out fresh storage
+};
+
+// Buffer for data rewritten every frame. In persistent mode storage is split into REGION_COUNT regions,
+// each frame writes into next one and fence placed after its draws guards it from being overwritten
+// while GPU may still read it, so there is no copy and CPU only waits if it gets REGION_COUNT frames ahead.
+// Without ARB_buffer_storage (or if requested) falls back to orphaning single region every frame.
+// Usage per frame: map(), write up to getRegionSize() bytes, unmap(), draw using getRegionOffset(), lockRegion()
+class StreamBuffer {
+    public:
+        static const unsigned int REGION_COUNT = 3;
+
+        StreamBuffer(GLenum target, unsigned int regionSize, bool allowPersistent = true);
+        ~StreamBuffer();
+
+        StreamBuffer(const StreamBuffer&) = delete;
+        StreamBuffer& operator=(const StreamBuffer&) = delete;
+
+        void* map();
+        void unmap();
+        // Must be called after last draw reading current region was issued, moves on to next region
+        void lockRegion();
+
+        void bind() const;
+        void unbind() const;
+
+        // Byte offset of the region returned by last map(), divide by stride for base vertex
+        inline unsigned int getRegionOffset() const { return currentRegion * regionSize; }
+        inline unsigned int getRegionSize() const { return regionSize; }
+        inline unsigned int getRendererID() const { return rendererID; }
+        inline StreamBufferMode getMode() const { return mode; }
+        // Times map() had to wait for GPU, should stay 0
+        inline unsigned int getStallCount() const { return stallCount; }
+    private:
+        unsigned int rendererID;
+        GLenum target;
+        unsigned int regionSize;
+        StreamBufferMode mode;
+
+        void* persistentData; ///< Whole storage, mapped for lifetime of the buffer
+        GLsync fences[REGION_COUNT];
+        unsigned int currentRegion;
+        unsigned int stallCount;
+};
+
+#endif // __StreamBuffer__
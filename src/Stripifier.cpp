@@ -0,0 +1,119 @@
+#include "Stripifier.hpp"
+
+#include "IndexBuffer.hpp"
+
+#include <cstdint>
+#include <unordered_map>
+
+namespace {
+    struct Adjacency {
+        const std::vector<unsigned int>& triangles;
+        // Directed edge (from << 32 | to) to corners starting it, corner is triangle * 3 + position
+        std::unordered_map<uint64_t, std::vector<unsigned int>> edges;
+        std::vector<bool> used;
+
+        Adjacency(const std::vector<unsigned int>& triangles)
+            : triangles(triangles), used(triangles.size() / 3, false) {
+            for (unsigned int corner = 0; corner < used.size() * 3; corner++)
+                edges[key(triangles[corner], next(corner))].push_back(corner);
+        }
+
+        static uint64_t key(unsigned int from, unsigned int to) {
+            return (static_cast<uint64_t>(from) << 32) | to;
+        }
+
+        unsigned int next(unsigned int corner, unsigned int step = 1) const {
+            unsigned int triangle = corner / 3;
+            return triangles[triangle * 3 + (corner % 3 + step) % 3];
+        }
+
+        // Unused triangle containing directed edge from -> to, returns its third vertex
+        bool findNeighbour(unsigned int from, unsigned int to, unsigned int& triangle, unsigned int& third) const {
+            auto it = edges.find(key(from, to));
+            if (it == edges.end())
+                return false;
+            for (unsigned int corner : it->second) {
+                if (!used[corner / 3]) {
+                    triangle = corner / 3;
+                    third = next(corner, 2);
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // Grows strip starting with given rotation of triangle, marks every triangle it takes
+        void buildStrip(unsigned int start, unsigned int rotation, std::vector<unsigned int>& strip, std::vector<unsigned int>& taken) {
+            strip.clear();
+            for (unsigned int i = 0; i < 3; i++)
+                strip.push_back(triangles[start * 3 + (rotation + i) % 3]);
+            used[start] = true;
+            taken.push_back(start);
+
+            for (;;) {
+                // Odd triangles of strip are drawn with first two vertices swapped,
+                // so neighbour must run along shared edge in opposite direction
+                unsigned int p = strip[strip.size() - 2];
+                unsigned int q = strip[strip.size() - 1];
+                bool even = (strip.size() - 2) % 2 == 0;
+                unsigned int triangle, third;
+                if (!(even ? findNeighbour(p, q, triangle, third) : findNeighbour(q, p, triangle, third)))
+                    break;
+                strip.push_back(third);
+                used[triangle] = true;
+                taken.push_back(triangle);
+            }
+        }
+    };
+
+    bool isDegenerate(const std::vector<unsigned int>& triangles, unsigned int triangle) {
+        unsigned int a = triangles[triangle * 3], b = triangles[triangle * 3 + 1], c = triangles[triangle * 3 + 2];
+        return a == b || b == c || c == a;
+    }
+}
+
+bool Stripifier::stripify(const std::vector<unsigned int>& triangles, std::vector<unsigned int>& strips) {
+    strips.clear();
+    unsigned int triangleCount = triangles.size() / 3;
+    if (triangleCount == 0)
+        return false;
+
+    Adjacency adjacency(triangles);
+    // Degenerate triangles draw nothing and would only break strips
+    for (unsigned int triangle = 0; triangle < triangleCount; triangle++) {
+        if (isDegenerate(triangles, triangle))
+            adjacency.used[triangle] = true;
+    }
+
+    std::vector<unsigned int> strip, best, taken;
+    for (unsigned int start = 0; start < triangleCount; start++) {
+        if (adjacency.used[start])
+            continue;
+
+        // Try every rotation of starting triangle and keep the one producing longest strip
+        unsigned int bestRotation = 0;
+        unsigned int bestLength = 0;
+        for (unsigned int rotation = 0; rotation < 3; rotation++) {
+            taken.clear();
+            adjacency.buildStrip(start, rotation, strip, taken);
+            for (unsigned int triangle : taken)
+                adjacency.used[triangle] = false;
+            if (strip.size() > bestLength) {
+                bestLength = strip.size();
+                bestRotation = rotation;
+            }
+        }
+        taken.clear();
+        adjacency.buildStrip(start, bestRotation, best, taken);
+
+        if (!strips.empty())
+            strips.push_back(IndexBuffer::RESTART_INDEX);
+        strips.insert(strips.end(), best.begin(), best.end());
+    }
+
+    if (strips.size() >= triangles.size()) {
+        strips.clear();
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,15 @@
+#ifndef __Stripifier__
+#define __Stripifier__
+
+#include <vector>
+
+// Greedy conversion of indexed triangle list into triangle strips joined by IndexBuffer::RESTART_INDEX.
+// Winding of every triangle is kept, so face culling still works. Strips only pay off for meshes
+// which share vertices between neighbouring triangles, so import must join identical vertices first
+class Stripifier {
+    public:
+        // Returns false and leaves strips empty if strips would not need fewer indices than the list
+        static bool stripify(const std::vector<unsigned int>& triangles, std::vector<unsigned int>& strips);
+};
+
+#endif // __Stripifier__
@@ -1,11 +1,15 @@
 #include "Texture.hpp"
 
 #include "stb_image.h"
+#include "GLState.hpp"
+#include "CPUProfiler.hpp"
+#include "UploadQueue.hpp"
 
 #include <iostream>
 
 Texture::Texture(const std::string& fileName)
-    : rendererID(0), filePath(fileName), localBuffer(nullptr), width(0), height(0), BPP(0), target(GL_TEXTURE_2D) {
+    : rendererID(TextureHandle::create()), filePath(fileName), localBuffer(nullptr), width(0), height(0), BPP(0), target(GL_TEXTURE_2D) {
+    PROFILE_SCOPE("Texture::Texture");
 
     // Not sure why I need to flip texture for GL
     stbi_set_flip_vertically_on_load(1);
@@ -13,12 +17,12 @@ Texture::Texture(const std::string& fileName)
     std::cout << "Loading texture: " << fileName.c_str() << std::endl;
     localBuffer = stbi_load(fileName.c_str(), &width, &height, &BPP, 4);
 
-    GLCall(glGenTextures(1, &rendererID));
-    GLCall(glBindTexture(GL_TEXTURE_2D, rendererID));
+    GLState::bindTexture(GL_TEXTURE_2D, rendererID.get());
 
-    // Generate texture
-    GLCall(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, localBuffer));
-    GLCall(glGenerateMipmap(GL_TEXTURE_2D));
+    // Only storage is created here, pixels and mipmaps arrive through UploadQueue over next frames
+    GLCall(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr));
+    if (localBuffer)
+        UploadQueue::enqueueTexture(rendererID.get(), GL_TEXTURE_2D, GL_TEXTURE_2D, width, height, GL_RGBA, 4, localBuffer, true);
 
     // Tell open GL how to filter texture when minifying or magnifying
     // how to wrap texture on x(s) and y(t) axis
@@ -30,25 +34,28 @@ Texture::Texture(const std::string& fileName)
     //GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
     // TODO: do I need mipmap stuff?
 
-    GLCall(glBindTexture(GL_TEXTURE_2D, 0));
+    GLState::bindTexture(GL_TEXTURE_2D, 0);
 
     if (localBuffer)
         stbi_image_free(localBuffer);
 }
 
 Texture::Texture(std::vector<std::string> faces)
-    : rendererID(0), localBuffer(nullptr), width(0), height(0), BPP(0), target(GL_TEXTURE_CUBE_MAP) {
+    : rendererID(TextureHandle::create()), localBuffer(nullptr), width(0), height(0), BPP(0), target(GL_TEXTURE_CUBE_MAP) {
+    PROFILE_SCOPE("Texture::Texture (cubemap)");
     stbi_set_flip_vertically_on_load(0);
 
-    GLCall(glGenTextures(1, &rendererID));
-    GLCall(glBindTexture(GL_TEXTURE_CUBE_MAP, rendererID));
+    GLState::bindTexture(GL_TEXTURE_CUBE_MAP, rendererID.get());
 
     for (unsigned int i = 0; i < faces.size(); i++) {
         localBuffer = stbi_load(faces[i].c_str(), &width, &height, &BPP, 0);
 
         if (localBuffer) {
+            GLenum format = (BPP == 4) ? GL_RGBA : GL_RGB;
             GLCall(glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0,
-                        GL_RGBA, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, localBuffer));
+                        GL_RGBA, width, height, 0, format, GL_UNSIGNED_BYTE, nullptr));
+            UploadQueue::enqueueTexture(rendererID.get(), GL_TEXTURE_CUBE_MAP, GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, width, height,
+                    format, BPP, localBuffer);
             stbi_image_free(localBuffer);
         } else {
             std::cout << "Failed loading cubemap texture : " << faces[i] << std::endl;
@@ -61,22 +68,21 @@ Texture::Texture(std::vector<std::string> faces)
     GLCall(glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
     GLCall(glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE));
 
-    GLCall(glBindTexture(GL_TEXTURE_2D, 0));
+    GLState::bindTexture(GL_TEXTURE_CUBE_MAP, 0);
 
     stbi_set_flip_vertically_on_load(1);
 }
 
 Texture::~Texture() {
-    std::cout << "Deleting texture: " << filePath << std::endl;
-    GLCall(glDeleteTextures(1, &rendererID));
+    // Texture itself is deleted later by DeletionQueue
+    UploadQueue::cancelTexture(rendererID.get());
 }
 
 void Texture::bind(unsigned int slot) const {
-    GLCall(glActiveTexture(GL_TEXTURE0 + slot));
-    GLCall(glBindTexture(target, rendererID));
+    GLState::bindTexture(slot, target, rendererID.get());
 }
 
 void Texture::unbind() const {
-    GLCall(glBindTexture(target, 0));
+    GLState::bindTexture(target, 0);
 }
 
@@ -2,6 +2,7 @@
 #define __Texture__
 
 #include "Renderer.hpp"
+#include "GLHandle.hpp"
 #include <vector>
 
 class Texture {
@@ -21,9 +22,9 @@ class Texture {
         void setType(std::string& t) { type = t; }
         inline std::string getType() const { return type; }
 
-        unsigned int getID() { return rendererID; }
+        unsigned int getID() const { return rendererID.get(); }
     private:
-        unsigned int rendererID;
+        TextureHandle rendererID;
         std::string filePath;
         unsigned char* localBuffer;
         int width, height, BPP; // Bits per picture
@@ -0,0 +1,61 @@
+#include "Uniform.hpp"
+
+#include "Renderer.hpp"
+
+// Location -1 is silently ignored by GL, so invalid handles need no check here
+
+void setUniformValue(int location, int value) {
+    GLCall(glUniform1i(location, value));
+}
+
+void setUniformValue(int location, float value) {
+    GLCall(glUniform1f(location, value));
+}
+
+void setUniformValue(int location, const glm::vec2& value) {
+    GLCall(glUniform2f(location, value.x, value.y));
+}
+
+void setUniformValue(int location, const glm::vec3& value) {
+    GLCall(glUniform3f(location, value.x, value.y, value.z));
+}
+
+void setUniformValue(int location, const glm::vec4& value) {
+    GLCall(glUniform4f(location, value.x, value.y, value.z, value.w));
+}
+
+void setUniformValue(int location, const glm::mat3& value) {
+    GLCall(glUniformMatrix3fv(location, 1, GL_FALSE, &value[0][0]));
+}
+
+void setUniformValue(int location, const glm::mat4& value) {
+    GLCall(glUniformMatrix4fv(location, 1, GL_FALSE, &value[0][0]));
+}
+
+void setProgramUniformValue(unsigned int program, int location, int value) {
+    GLCall(glProgramUniform1i(program, location, value));
+}
+
+void setProgramUniformValue(unsigned int program, int location, float value) {
+    GLCall(glProgramUniform1f(program, location, value));
+}
+
+void setProgramUniformValue(unsigned int program, int location, const glm::vec2& value) {
+    GLCall(glProgramUniform2f(program, location, value.x, value.y));
+}
+
+void setProgramUniformValue(unsigned int program, int location, const glm::vec3& value) {
+    GLCall(glProgramUniform3f(program, location, value.x, value.y, value.z));
+}
+
+void setProgramUniformValue(unsigned int program, int location, const glm::vec4& value) {
+    GLCall(glProgramUniform4f(program, location, value.x, value.y, value.z, value.w));
+}
+
+void setProgramUniformValue(unsigned int program, int location, const glm::mat3& value) {
+    GLCall(glProgramUniformMatrix3fv(program, location, 1, GL_FALSE, &value[0][0]));
+}
+
+void setProgramUniformValue(unsigned int program, int location, const glm::mat4& value) {
+    GLCall(glProgramUniformMatrix4fv(program, location, 1, GL_FALSE, &value[0][0]));
+}
@@ -0,0 +1,74 @@
+#ifndef __Uniform__
+#define __Uniform__
+
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+#include "glm/glm.hpp"
+
+// FNV-1a of uniform name, constexpr so names known at compile time are hashed by the compiler
+constexpr uint64_t hashUniformName(const char* name) {
+    uint64_t hash = 14695981039346656037ull;
+    for (; *name; name++)
+        hash = (hash ^ static_cast<unsigned char>(*name)) * 1099511628211ull;
+    return hash;
+}
+
+// Uniform name together with its hash, shaders look locations up by hash only, so passing name does no
+// allocation. Name itself is only read if uniform turns out to be missing. Plain literal is still hashed
+// at runtime unless compiler folds it, name known at compile time should go through UNIFORM("u_name")
+struct UniformName {
+    constexpr UniformName(const char* name) : name(name), hash(hashUniformName(name)) {}
+    constexpr UniformName(const char* name, uint64_t hash) : name(name), hash(hash) {}
+    UniformName(const std::string& name) : name(name.c_str()), hash(hashUniformName(name.c_str())) {}
+
+    const char* name; ///< Not owned, valid only during the call for temporary strings
+    uint64_t hash;
+};
+
+// Hash is template argument, so compiler has to compute it, also in unoptimized builds
+#define UNIFORM(name) UniformName(name, std::integral_constant<uint64_t, hashUniformName(name)>::value)
+
+// Overloads pick glUniform* call at compile time, program must be bound
+void setUniformValue(int location, int value);
+void setUniformValue(int location, float value);
+void setUniformValue(int location, const glm::vec2& value);
+void setUniformValue(int location, const glm::vec3& value);
+void setUniformValue(int location, const glm::vec4& value);
+void setUniformValue(int location, const glm::mat3& value);
+void setUniformValue(int location, const glm::mat4& value);
+// Same for separable stage program of pipeline, which is set without being bound
+void setProgramUniformValue(unsigned int program, int location, int value);
+void setProgramUniformValue(unsigned int program, int location, float value);
+void setProgramUniformValue(unsigned int program, int location, const glm::vec2& value);
+void setProgramUniformValue(unsigned int program, int location, const glm::vec3& value);
+void setProgramUniformValue(unsigned int program, int location, const glm::vec4& value);
+void setProgramUniformValue(unsigned int program, int location, const glm::mat3& value);
+void setProgramUniformValue(unsigned int program, int location, const glm::mat4& value);
+
+// Typed uniform location, resolved once from linked program (Shader::getUniform()), so setting it is
+// single glUniform* call without any lookup. Default constructed handle is invalid and setting it does nothing
+template <typename T>
+class Uniform {
+    public:
+        Uniform() : location(-1), program(0) {}
+        // Program is given for stages of pipelines only
+        explicit Uniform(int location, unsigned int program = 0) : location(location), program(program) {}
+
+        // Program which handle came from must be bound, unless it is pipeline
+        inline void set(const T& value) const {
+            if (program)
+                setProgramUniformValue(program, location, value);
+            else
+                setUniformValue(location, value);
+        }
+
+        inline bool isValid() const { return location != -1; }
+        inline int getLocation() const { return location; }
+    private:
+        int location;
+        unsigned int program;
+};
+
+#endif // __Uniform__
@@ -0,0 +1,258 @@
+#include "UploadQueue.hpp"
+
+#include "Renderer.hpp"
+#include "GLState.hpp"
+#include "StreamBuffer.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <vector>
+
+namespace {
+    // Staging offsets are kept aligned, pixel unpack offsets must be multiple of pixel size
+    const unsigned int STAGING_ALIGNMENT = 16;
+
+    struct Upload {
+        bool texture;
+        unsigned int object;
+        uint64_t ticket = 0;
+        std::vector<unsigned char> data;
+        unsigned int uploaded = 0; ///< Bytes already copied
+
+        unsigned int offset = 0; ///< Buffers: destination offset
+
+        GLenum target = 0; ///< Textures: GL_TEXTURE_2D or GL_TEXTURE_CUBE_MAP
+        GLenum face = 0;
+        int width = 0;
+        int height = 0;
+        GLenum format = 0;
+        unsigned int rowSize = 0;
+        bool generateMipmap = false;
+    };
+
+    struct Copy {
+        Upload* upload;
+        unsigned int stagingOffset;
+        unsigned int size;
+    };
+
+    struct State {
+        std::deque<Upload> uploads; ///< Processed strictly in order
+        uint64_t nextTicket = 1;
+        std::unique_ptr<StreamBuffer> staging;
+        unsigned int frameBudget = 8 * 1024 * 1024;
+        unsigned int pendingBytes = 0;
+        unsigned int lastBytesUploaded = 0;
+    };
+
+    State& state() {
+        static State s;
+        return s;
+    }
+
+    // Upload is done, texture may need its mipmaps now
+    void complete(const Upload& upload) {
+        if (upload.texture && upload.generateMipmap) {
+            GLState::bindTexture(upload.target, upload.object);
+            GLCall(glGenerateMipmap(upload.target));
+        }
+    }
+
+    // Issues copies from staging region for part of upload which was written at stagingOffset
+    void copyFromStaging(const StreamBuffer& staging, const Copy& copy) {
+        Upload& upload = *copy.upload;
+        unsigned int source = staging.getRegionOffset() + copy.stagingOffset;
+        if (!upload.texture) {
+            GLState::bindBuffer(GL_COPY_WRITE_BUFFER, upload.object);
+            GLCall(glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, source, upload.offset + upload.uploaded, copy.size));
+        } else {
+            GLState::bindTexture(upload.target, upload.object);
+            int firstRow = upload.uploaded / upload.rowSize;
+            int rows = copy.size / upload.rowSize;
+            GLCall(glTexSubImage2D(upload.face, 0, 0, firstRow, upload.width, rows, upload.format, GL_UNSIGNED_BYTE,
+                        (const void*)(uintptr_t)source));
+        }
+        upload.uploaded += copy.size;
+    }
+
+    // Synchronous fallback from client memory, for failed staging map or texture row bigger than whole staging region
+    void uploadDirect(Upload& upload, unsigned int size) {
+        GLState::bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        if (!upload.texture) {
+            GLState::bindBuffer(GL_COPY_WRITE_BUFFER, upload.object);
+            GLCall(glBufferSubData(GL_COPY_WRITE_BUFFER, upload.offset + upload.uploaded, size, &upload.data[upload.uploaded]));
+        } else {
+            GLState::bindTexture(upload.target, upload.object);
+            int firstRow = upload.uploaded / upload.rowSize;
+            int rows = (size + upload.rowSize - 1) / upload.rowSize;
+            GLCall(glTexSubImage2D(upload.face, 0, 0, firstRow, upload.width, rows, upload.format, GL_UNSIGNED_BYTE,
+                        &upload.data[upload.uploaded]));
+        }
+        upload.uploaded += size;
+    }
+
+    // Uploads up to budget bytes, returns number of bytes uploaded
+    unsigned int process(unsigned int budget) {
+        State& s = state();
+        if (s.uploads.empty())
+            return 0;
+        if (!s.staging || s.staging->getRegionSize() != budget)
+            s.staging = std::make_unique<StreamBuffer>(GL_COPY_READ_BUFFER, budget);
+
+        std::vector<Copy> copies;
+        unsigned int used = 0;
+        unsigned char* region = static_cast<unsigned char*>(s.staging->map());
+        for (Upload& upload : s.uploads) {
+            unsigned int remaining = upload.data.size() - upload.uploaded;
+            unsigned int space = used < budget ? budget - used : 0;
+            unsigned int size = std::min(remaining, space);
+            // Textures are copied in whole rows
+            if (upload.texture)
+                size -= size % upload.rowSize;
+            if (size == 0)
+                break;
+            if (region)
+                std::memcpy(region + used, &upload.data[upload.uploaded], size);
+            copies.push_back({&upload, used, size});
+            used = (used + size + STAGING_ALIGNMENT - 1) / STAGING_ALIGNMENT * STAGING_ALIGNMENT;
+            if (size < remaining)
+                break;
+        }
+        if (region)
+            s.staging->unmap();
+
+        // Rows of 3 channel textures are not 4 byte aligned
+        GLCall(glPixelStorei(GL_UNPACK_ALIGNMENT, 1));
+        unsigned int uploaded = 0;
+        if (copies.empty()) {
+            Upload& upload = s.uploads.front();
+            uploaded = upload.data.size() - upload.uploaded;
+            uploadDirect(upload, uploaded);
+        } else if (!region) {
+            for (const Copy& copy : copies) {
+                uploadDirect(*copy.upload, copy.size);
+                uploaded += copy.size;
+            }
+        } else {
+            s.staging->bind();
+            GLState::bindBuffer(GL_PIXEL_UNPACK_BUFFER, s.staging->getRendererID());
+            for (const Copy& copy : copies) {
+                copyFromStaging(*s.staging, copy);
+                uploaded += copy.size;
+            }
+            // Left bound, every other texture upload would read from it
+            GLState::bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            s.staging->lockRegion();
+        }
+        GLCall(glPixelStorei(GL_UNPACK_ALIGNMENT, 4));
+
+        while (!s.uploads.empty() && s.uploads.front().uploaded == s.uploads.front().data.size()) {
+            complete(s.uploads.front());
+            s.uploads.pop_front();
+        }
+        s.pendingBytes -= uploaded;
+        return uploaded;
+    }
+
+    void cancel(bool texture, unsigned int object) {
+        State& s = state();
+        for (auto it = s.uploads.begin(); it != s.uploads.end();) {
+            if (it->texture == texture && it->object == object) {
+                s.pendingBytes -= it->data.size() - it->uploaded;
+                it = s.uploads.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+}
+
+uint64_t UploadQueue::enqueueBuffer(unsigned int buffer, unsigned int offset, const void* data, unsigned int size) {
+    if (size == 0)
+        return 0;
+    Upload upload;
+    upload.texture = false;
+    upload.object = buffer;
+    upload.ticket = state().nextTicket++;
+    upload.offset = offset;
+    upload.data.assign(static_cast<const unsigned char*>(data), static_cast<const unsigned char*>(data) + size);
+    state().pendingBytes += size;
+    uint64_t ticket = upload.ticket;
+    state().uploads.push_back(std::move(upload));
+    return ticket;
+}
+
+void UploadQueue::enqueueTexture(unsigned int texture, GLenum target, GLenum face, int width, int height,
+        GLenum format, unsigned int channels, const void* pixels, bool generateMipmap) {
+    unsigned int size = width * height * channels;
+    if (size == 0)
+        return;
+    Upload upload;
+    upload.texture = true;
+    upload.object = texture;
+    upload.target = target;
+    upload.face = face;
+    upload.width = width;
+    upload.height = height;
+    upload.format = format;
+    upload.rowSize = width * channels;
+    upload.generateMipmap = generateMipmap;
+    upload.ticket = state().nextTicket++;
+    upload.data.assign(static_cast<const unsigned char*>(pixels), static_cast<const unsigned char*>(pixels) + size);
+    state().pendingBytes += size;
+    state().uploads.push_back(std::move(upload));
+}
+
+void UploadQueue::cancelBuffer(unsigned int buffer) {
+    cancel(false, buffer);
+}
+
+void UploadQueue::cancelTexture(unsigned int texture) {
+    cancel(true, texture);
+}
+
+bool UploadQueue::isComplete(uint64_t ticket) {
+    const std::deque<Upload>& uploads = state().uploads;
+    return uploads.empty() || ticket < uploads.front().ticket;
+}
+
+void UploadQueue::flush() {
+    State& s = state();
+    s.lastBytesUploaded = process(s.frameBudget);
+}
+
+void UploadQueue::finish() {
+    State& s = state();
+    while (!s.uploads.empty())
+        process(s.frameBudget);
+}
+
+void UploadQueue::shutdown() {
+    State& s = state();
+    s.uploads.clear();
+    s.pendingBytes = 0;
+    s.staging.reset();
+}
+
+void UploadQueue::setFrameBudget(unsigned int bytes) {
+    state().frameBudget = std::max(bytes, STAGING_ALIGNMENT);
+}
+
+unsigned int UploadQueue::getFrameBudget() {
+    return state().frameBudget;
+}
+
+unsigned int UploadQueue::getBytesUploaded() {
+    return state().lastBytesUploaded;
+}
+
+unsigned int UploadQueue::getPendingBytes() {
+    return state().pendingBytes;
+}
+
+unsigned int UploadQueue::getPendingCount() {
+    return state().uploads.size();
+}
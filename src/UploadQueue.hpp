@@ -0,0 +1,47 @@
+#ifndef __UploadQueue__
+#define __UploadQueue__
+
+#include <GL/glew.h>
+
+#include <cstdint>
+
+// Defers resource uploads instead of issuing synchronous glBufferData/glTexImage2D from constructors.
+// Data is copied aside when enqueued, flush() packs as much of it as frame budget allows into one staging
+// StreamBuffer and copies it into destinations with glCopyBufferSubData, or glTexSubImage2D from the staging
+// buffer bound as pixel unpack buffer. Big buffers and textures are split (textures by rows), so loading
+// them is spread across frames instead of causing a hitch. Until an upload completes its destination
+// holds undefined data, e.g. textures sample black. Geometry must not be drawn before that, so buffer uploads
+// return a ticket which owners check with isComplete() and skip their draws until it is.
+// flush() runs once per frame before the test updates, shutdown() must be called while context exists
+class UploadQueue {
+    public:
+        // Destination must already have storage for offset + size bytes, returns ticket of the upload
+        static uint64_t enqueueBuffer(unsigned int buffer, unsigned int offset, const void* data, unsigned int size);
+        // Whole level 0 of texture (or one cube face), storage must already be allocated.
+        // Face is GL_TEXTURE_2D or one of GL_TEXTURE_CUBE_MAP_*, pixels are GL_UNSIGNED_BYTE with channels per pixel
+        static void enqueueTexture(unsigned int texture, GLenum target, GLenum face, int width, int height,
+                GLenum format, unsigned int channels, const void* pixels, bool generateMipmap = false);
+
+        // Destinations about to be deleted, their pending uploads are dropped
+        static void cancelBuffer(unsigned int buffer);
+        static void cancelTexture(unsigned int texture);
+
+        // Uploads complete in order, so this is also true for every upload enqueued before. Ticket 0 is always complete
+        static bool isComplete(uint64_t ticket);
+
+        // Uploads pending data up to frame budget
+        static void flush();
+        // Uploads everything pending, ignoring budget
+        static void finish();
+        static void shutdown();
+
+        static void setFrameBudget(unsigned int bytes);
+        static unsigned int getFrameBudget();
+
+        // Bytes uploaded by last flush()
+        static unsigned int getBytesUploaded();
+        static unsigned int getPendingBytes();
+        static unsigned int getPendingCount();
+};
+
+#endif // __UploadQueue__
@@ -2,6 +2,7 @@
 #define __Vertex__
 
 #include "glm/glm.hpp"
+#include "VertexFormat.hpp"
 
 struct Vertex {
     glm::vec3 Position;
@@ -9,4 +10,25 @@ struct Vertex {
     //glm::vec3 Color;
     glm::vec2 TexCoords;
 };
+
+using MeshVertexFormat = VertexFormat<Vertex,
+      VERTEX_MEMBER(Vertex, Position),
+      VERTEX_MEMBER(Vertex, Normal),
+      VERTEX_MEMBER(Vertex, TexCoords)>;
+
+// Same attributes split into two streams, so depth only passes fetch just 12 bytes of positions per vertex.
+// With attribute stream bound after position stream, attributes keep locations of MeshVertexFormat
+struct VertexPosition {
+    glm::vec3 Position;
+};
+
+struct VertexAttributes {
+    glm::vec3 Normal;
+    glm::vec2 TexCoords;
+};
+
+using PositionStreamFormat = VertexFormat<VertexPosition, VERTEX_MEMBER(VertexPosition, Position)>;
+using AttributeStreamFormat = VertexFormat<VertexAttributes,
+      VERTEX_MEMBER(VertexAttributes, Normal),
+      VERTEX_MEMBER(VertexAttributes, TexCoords)>;
 #endif // __Vertex__
@@ -2,41 +2,147 @@
 
 #include "VertexBufferLayout.hpp"
 #include "Renderer.hpp"
+#include "GLState.hpp"
+#include "StreamBuffer.hpp"
 
-VertexArray::VertexArray() {
-    // Using vertex array means we dont need to specigy vertex attributes every time we draw
-    // also let's us specify different vertex layouts, default vao can be used with compability profile
-    // core profile requires vao to be set
-    GLCall(glGenVertexArrays(1, &rendererID));
-}
+#include <cstdint>
 
-VertexArray::~VertexArray() {
-    GLCall(glDeleteVertexArrays(1, &rendererID));
+// Using vertex array means we dont need to specigy vertex attributes every time we draw
+// also let's us specify different vertex layouts, default vao can be used with compability profile
+// core profile requires vao to be set
+VertexArray::VertexArray()
+    : rendererID(VertexArrayHandle::create()) {
 }
 
-void VertexArray::addBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout) {
+void VertexArray::addBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout, unsigned int firstLocation, unsigned int divisor) {
     bind();
     // First bind vertex buffer of course
     vb.bind();
+    setAttributes(layout, firstLocation, divisor);
+}
+
+void VertexArray::addBuffer(const StreamBuffer& sb, const VertexBufferLayout& layout, unsigned int firstLocation, unsigned int divisor) {
+    bind();
+    sb.bind();
+    setAttributes(layout, firstLocation, divisor);
+}
+
+void VertexArray::addBuffer(const VertexBuffer& vb, const VertexFormatView& format, unsigned int firstLocation, unsigned int divisor) {
+    bind();
+    vb.bind();
+    setAttributes(format, firstLocation, divisor);
+}
+
+void VertexArray::addBuffer(const StreamBuffer& sb, const VertexFormatView& format, unsigned int firstLocation, unsigned int divisor) {
+    bind();
+    sb.bind();
+    setAttributes(format, firstLocation, divisor);
+}
 
+void VertexArray::setAttributes(const VertexBufferLayout& layout, unsigned int firstLocation, unsigned int divisor) {
     // Specifying vertex layout below by enabling and configuring vertex vattributes
     const auto& elements = layout.getElements();
     unsigned int offset = 0;
     for (unsigned int i = 0; i < elements.size(); i++) {
         const auto& element = elements[i];
+        unsigned int location = firstLocation + i;
         // Enable vertex attributes
-        GLCall(glEnableVertexAttribArray(i));
+        GLCall(glEnableVertexAttribArray(location));
         // Set up vertex attributes (position, colour, texture uv, normals)
-        GLCall(glVertexAttribPointer(i, element.count, element.type, element.normalised, layout.getStride(), (const void*)offset));
-        offset += element.count * VertexBufferElement::getSizeOfType(element.type);
+        GLCall(glVertexAttribPointer(location, element.count, element.type, element.normalised, layout.getStride(), (const void*)(uintptr_t)offset));
+        if (divisor > 0) {
+            GLCall(glVertexAttribDivisor(location, divisor));
+        }
+        offset += VertexBufferElement::getSizeOfAttribute(element.type, element.count);
+    }
+}
+
+void VertexArray::setFormat(const VertexFormatView& format, unsigned int bindingIndex, unsigned int firstLocation, unsigned int divisor) {
+    if (bindings.size() <= bindingIndex)
+        bindings.resize(bindingIndex + 1);
+    bindings[bindingIndex] = {format, firstLocation, divisor};
+    // Later binding takes over locations it shares with earlier ones
+    unsigned int location = firstLocation;
+    for (unsigned int i = 0; i < format.attributeCount; i++) {
+        for (unsigned int column = 0; column < format.attributes[i].locations; column++, location++) {
+            if (locationBindings.size() <= location)
+                locationBindings.resize(location + 1);
+            locationBindings[location] = bindingIndex;
+        }
+    }
+    if (!GLEW_ARB_vertex_attrib_binding)
+        return;
+
+    bind();
+    location = firstLocation;
+    for (unsigned int i = 0; i < format.attributeCount; i++) {
+        const VertexAttribute& attribute = format.attributes[i];
+        unsigned int columnSize = VertexBufferElement::getSizeOfAttribute(attribute.type, attribute.count);
+        for (unsigned int column = 0; column < attribute.locations; column++, location++) {
+            GLCall(glEnableVertexAttribArray(location));
+            GLCall(glVertexAttribFormat(location, attribute.count, attribute.type, attribute.normalised,
+                        attribute.offset + column * columnSize));
+            GLCall(glVertexAttribBinding(location, bindingIndex));
+        }
+    }
+    GLCall(glVertexBindingDivisor(bindingIndex, divisor));
+}
+
+void VertexArray::setFormats(const std::vector<VertexFormatView>& streams) {
+    unsigned int location = 0;
+    for (unsigned int i = 0; i < streams.size(); i++) {
+        setFormat(streams[i], i, location);
+        location += streams[i].getLocationCount();
+    }
+}
+
+void VertexArray::bindVertexBuffer(unsigned int bindingIndex, const VertexBuffer& vb, unsigned int offset) {
+    const Binding& binding = bindings[bindingIndex];
+    bind();
+    if (GLEW_ARB_vertex_attrib_binding) {
+        GLCall(glBindVertexBuffer(bindingIndex, vb.getRendererID(), offset, binding.format.stride));
+        return;
+    }
+
+    vb.bind();
+    const VertexFormatView& format = binding.format;
+    unsigned int location = binding.firstLocation;
+    for (unsigned int i = 0; i < format.attributeCount; i++) {
+        const VertexAttribute& attribute = format.attributes[i];
+        unsigned int columnSize = VertexBufferElement::getSizeOfAttribute(attribute.type, attribute.count);
+        for (unsigned int column = 0; column < attribute.locations; column++, location++) {
+            if (locationBindings[location] != bindingIndex)
+                continue;
+            GLCall(glEnableVertexAttribArray(location));
+            GLCall(glVertexAttribPointer(location, attribute.count, attribute.type, attribute.normalised, format.stride,
+                        (const void*)(uintptr_t)(offset + attribute.offset + column * columnSize)));
+            GLCall(glVertexAttribDivisor(location, binding.divisor));
+        }
+    }
+}
+
+void VertexArray::setAttributes(const VertexFormatView& format, unsigned int firstLocation, unsigned int divisor) {
+    unsigned int location = firstLocation;
+    for (unsigned int i = 0; i < format.attributeCount; i++) {
+        const VertexAttribute& attribute = format.attributes[i];
+        unsigned int columnSize = VertexBufferElement::getSizeOfAttribute(attribute.type, attribute.count);
+        // Matrices take one location per column
+        for (unsigned int column = 0; column < attribute.locations; column++, location++) {
+            GLCall(glEnableVertexAttribArray(location));
+            GLCall(glVertexAttribPointer(location, attribute.count, attribute.type, attribute.normalised, format.stride,
+                        (const void*)(uintptr_t)(attribute.offset + column * columnSize)));
+            if (divisor > 0) {
+                GLCall(glVertexAttribDivisor(location, divisor));
+            }
+        }
     }
 }
 
 void VertexArray::bind() const {
-    GLCall(glBindVertexArray(rendererID));
+    GLState::bindVertexArray(rendererID.get());
 }
 
 void VertexArray::unbind() const {
-    GLCall(glBindVertexArray(0));
+    GLState::bindVertexArray(0);
 }
 
@@ -2,21 +2,56 @@
 #define __VertexArray__
 
 #include "VertexBuffer.hpp"
+#include "GLHandle.hpp"
+#include "VertexFormat.hpp"
+
+#include <vector>
 
 class VertexBufferLayout;
+class StreamBuffer;
 
 class VertexArray {
     public:
         VertexArray();
-        ~VertexArray();
 
-        void addBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout);
+        // Attributes of the layout get consecutive locations starting from firstLocation,
+        // non zero divisor makes them instanced arrays
+        void addBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout, unsigned int firstLocation = 0, unsigned int divisor = 0);
+        // Attributes point at the start of the buffer, draws select region of the stream with base vertex
+        void addBuffer(const StreamBuffer& sb, const VertexBufferLayout& layout, unsigned int firstLocation = 0, unsigned int divisor = 0);
+        // Same for compile time formats, e.g. addBuffer(vb, MeshVertexFormat::view())
+        void addBuffer(const VertexBuffer& vb, const VertexFormatView& format, unsigned int firstLocation = 0, unsigned int divisor = 0);
+        void addBuffer(const StreamBuffer& sb, const VertexFormatView& format, unsigned int firstLocation = 0, unsigned int divisor = 0);
+
+        // Separate attribute format and buffer binding (ARB_vertex_attrib_binding): format of binding point is set once,
+        // then buffers are switched with bindVertexBuffer() without touching attributes, so one VAO serves every
+        // buffer of that format. Without the extension attribute pointers are re-specified on every buffer switch instead
+        void setFormat(const VertexFormatView& format, unsigned int bindingIndex = 0, unsigned int firstLocation = 0,
+                unsigned int divisor = 0);
+        // Stream i goes to binding point i, locations continue from one stream to the next
+        void setFormats(const std::vector<VertexFormatView>& streams);
+        // Offset in bytes of the first vertex, stride comes from format set for the binding point
+        void bindVertexBuffer(unsigned int bindingIndex, const VertexBuffer& vb, unsigned int offset = 0);
 
         void bind() const;
         void unbind() const;
 
+        unsigned int getRendererID() const { return rendererID.get(); }
+
     private:
-        unsigned int rendererID;
+        struct Binding {
+            VertexFormatView format;
+            unsigned int firstLocation;
+            unsigned int divisor;
+        };
+
+        VertexArrayHandle rendererID;
+        std::vector<Binding> bindings; ///< Indexed by binding point, filled by setFormat()
+        std::vector<unsigned int> locationBindings; ///< Binding point each attribute location was last assigned to
+
+        // Sets up attributes of the layout for currently bound array buffer
+        void setAttributes(const VertexBufferLayout& layout, unsigned int firstLocation, unsigned int divisor);
+        void setAttributes(const VertexFormatView& format, unsigned int firstLocation, unsigned int divisor);
 
 };
 
@@ -1,24 +1,135 @@
 #include "VertexBuffer.hpp"
 
 #include "Renderer.hpp"
+#include "GLState.hpp"
+#include "UploadQueue.hpp"
 
-VertexBuffer::VertexBuffer(const void* data, unsigned int size, GLenum usage) {
-    GLCall(glGenBuffers(1, &rendererID));
-    GLCall(glBindBuffer(GL_ARRAY_BUFFER, rendererID));
-    // TODO: when setting GL_DYNAMIC_DRAW, data needs to be nullptr so glBufferData needs
-    // to know size and we will need a setter for data
+#include <algorithm>
+#include <cstring>
+
+namespace {
+    struct UploadStats {
+        unsigned int bytes = 0;
+        unsigned int calls = 0;
+        unsigned int lastBytes = 0;
+        unsigned int lastCalls = 0;
+    };
+
+    UploadStats& stats() {
+        static UploadStats s;
+        return s;
+    }
+
+    void countUpload(unsigned int bytes) {
+        stats().bytes += bytes;
+        stats().calls++;
+    }
+}
+
+VertexBuffer::VertexBuffer(const void* data, unsigned int size, GLenum usage)
+    : rendererID(BufferHandle::create()), size(size), usage(usage), mappedSize(0) {
+    GLState::bindBuffer(GL_ARRAY_BUFFER, rendererID.get());
     GLCall(glBufferData(GL_ARRAY_BUFFER, size, data, usage));
+    if (data)
+        countUpload(size);
 }
 
 VertexBuffer::~VertexBuffer() {
-    GLCall(glDeleteBuffers(1, &rendererID));
+    // Pooled geometry is uploaded into vertex buffers through the queue
+    UploadQueue::cancelBuffer(rendererID.get());
 }
 
 void VertexBuffer::bind() const {
-    GLCall(glBindBuffer(GL_ARRAY_BUFFER, rendererID));
+    GLState::bindBuffer(GL_ARRAY_BUFFER, rendererID.get());
 }
 
 void VertexBuffer::unbind() const {
-    GLCall(glBindBuffer(GL_ARRAY_BUFFER, 0));
+    GLState::bindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void VertexBuffer::setData(const void* data, unsigned int size) {
+    // Whole contents get replaced, so staged ranges are stale
+    dirtyRanges.clear();
+    if (size != this->size)
+        staging.clear();
+    this->size = size;
+
+    bind();
+    GLCall(glBufferData(GL_ARRAY_BUFFER, size, nullptr, usage));
+    if (data) {
+        GLCall(glBufferSubData(GL_ARRAY_BUFFER, 0, size, data));
+        countUpload(size);
+    }
+}
+
+void VertexBuffer::updateRange(unsigned int offset, unsigned int size, const void* data) {
+    if (size == 0)
+        return;
+    if (staging.size() != this->size)
+        staging.resize(this->size);
+    std::memcpy(&staging[offset], data, size);
+    dirtyRanges.push_back({offset, size});
+}
+
+void VertexBuffer::flush() {
+    if (dirtyRanges.empty())
+        return;
+
+    std::sort(dirtyRanges.begin(), dirtyRanges.end(), [](const Range& a, const Range& b) {
+        return a.offset < b.offset;
+    });
+    // Coalesce touching and overlapping ranges, gaps between them hold no staged data
+    std::vector<Range> merged;
+    merged.push_back(dirtyRanges[0]);
+    for (unsigned int i = 1; i < dirtyRanges.size(); i++) {
+        Range& last = merged.back();
+        const Range& range = dirtyRanges[i];
+        if (range.offset <= last.offset + last.size)
+            last.size = std::max(last.offset + last.size, range.offset + range.size) - last.offset;
+        else
+            merged.push_back(range);
+    }
+    dirtyRanges.clear();
+
+    bind();
+    for (const Range& range : merged) {
+        GLCall(glBufferSubData(GL_ARRAY_BUFFER, range.offset, range.size, &staging[range.offset]));
+        countUpload(range.size);
+    }
+}
+
+void* VertexBuffer::map(unsigned int offset, unsigned int size, bool unsynchronized) {
+    // Staged ranges would otherwise overwrite what gets written through the mapping
+    flush();
+
+    GLbitfield access = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT;
+    if (unsynchronized)
+        access |= GL_MAP_UNSYNCHRONIZED_BIT;
+    bind();
+    GLCall(void* data = glMapBufferRange(GL_ARRAY_BUFFER, offset, size, access));
+    mappedSize = data ? size : 0;
+    return data;
+}
+
+void VertexBuffer::unmap() {
+    bind();
+    GLCall(glUnmapBuffer(GL_ARRAY_BUFFER));
+    countUpload(mappedSize);
+    mappedSize = 0;
+}
+
+void VertexBuffer::newFrame() {
+    UploadStats& s = stats();
+    s.lastBytes = s.bytes;
+    s.lastCalls = s.calls;
+    s.bytes = 0;
+    s.calls = 0;
 }
 
+unsigned int VertexBuffer::getBytesUploaded() {
+    return stats().lastBytes;
+}
+
+unsigned int VertexBuffer::getUploadCalls() {
+    return stats().lastCalls;
+}
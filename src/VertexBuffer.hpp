@@ -2,16 +2,58 @@
 #define __VertexBuffer__
 
 #include <GL/glew.h>
+#include <vector>
 
+#include "GLHandle.hpp"
+
+// Vertex data in GPU memory. Besides replacing everything with setData(), dynamic buffers can be changed
+// partially: updateRange() only stages data and flush() uploads touching or overlapping ranges with one call each,
+// so many small changes in one frame cost few glBufferSubData calls. Bytes sent through any of these
+// are counted per frame for all buffers
 class VertexBuffer {
     public:
         VertexBuffer(const void* data, unsigned int size, GLenum usage = GL_STATIC_DRAW);
         ~VertexBuffer();
 
+        VertexBuffer(const VertexBuffer&) = delete;
+        VertexBuffer& operator=(const VertexBuffer&) = delete;
+
         void bind() const;
         void unbind() const;
+
+        // Replaces whole contents, old storage is orphaned so GPU keeps reading it without stalling the upload
+        void setData(const void* data, unsigned int size);
+        // Copies data aside and marks range dirty, nothing reaches GPU before flush()
+        void updateRange(unsigned int offset, unsigned int size, const void* data);
+        // Uploads dirty ranges, must be called before draws which read them
+        void flush();
+        // Maps range for writing, its previous contents are discarded. Unsynchronized mapping does not wait
+        // for GPU, so caller must not overwrite data of draws which may still be in flight
+        void* map(unsigned int offset, unsigned int size, bool unsynchronized = true);
+        void unmap();
+
+        inline unsigned int getRendererID() const { return rendererID.get(); }
+        inline unsigned int getSize() const { return size; }
+        inline bool hasPendingUpdates() const { return !dirtyRanges.empty(); }
+
+        // Called once per frame, stores counters of the finished frame and resets them
+        static void newFrame();
+        // Counters of the last finished frame
+        static unsigned int getBytesUploaded();
+        static unsigned int getUploadCalls();
     private:
-        unsigned int rendererID;
+        struct Range {
+            unsigned int offset;
+            unsigned int size;
+        };
+
+        BufferHandle rendererID;
+        unsigned int size;
+        GLenum usage;
+
+        std::vector<unsigned char> staging; ///< Allocated on first updateRange(), only dirty ranges are meaningful
+        std::vector<Range> dirtyRanges;
+        unsigned int mappedSize; ///< Size of current mapping, 0 when not mapped
 };
 
 #endif // __VertexBuffer__
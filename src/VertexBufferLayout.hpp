@@ -3,6 +3,7 @@
 
 #include <vector>
 #include "Renderer.hpp"
+#include "VertexPacking.hpp"
 
 struct VertexBufferElement {
     unsigned int type;
@@ -14,10 +15,23 @@ struct VertexBufferElement {
             case GL_FLOAT:              return 4;
             case GL_UNSIGNED_INT:       return 4;
             case GL_UNSIGNED_BYTE:      return 1;
+            case GL_HALF_FLOAT:         return 2;
+            case GL_SHORT:              return 2;
+            case GL_UNSIGNED_SHORT:     return 2;
         }
         ASSERT(false);
         return 0;
     }
+
+    // Size of whole attribute, packed types hold all components in 4 bytes
+    static unsigned int getSizeOfAttribute(unsigned int type, unsigned int count) {
+        switch(type) {
+            case GL_INT_2_10_10_10_REV:
+            case GL_UNSIGNED_INT_2_10_10_10_REV:
+                return 4;
+        }
+        return count * getSizeOfType(type);
+    }
 };
 
 class VertexBufferLayout {
@@ -27,12 +41,14 @@ class VertexBufferLayout {
         ~VertexBufferLayout() {
         }
 
+        // Only float, unsigned int, unsigned char, (unsigned) short, Half and PackedNormal are specialised,
+        // anything else fails to compile. Byte and short types are read as normalised 0-1 (-1-1 if signed) floats
         template <typename T> void push (unsigned int count) {
-            //static_assert(false);
+            static_assert(sizeof(T) == 0, "Unsupported vertex attribute type");
         }
 
 
-        inline const std::vector<VertexBufferElement> getElements() const { return elements; }
+        inline const std::vector<VertexBufferElement>& getElements() const { return elements; }
         inline unsigned int getStride() const { return stride; }
 
     private:
@@ -55,5 +71,26 @@ template<> inline void VertexBufferLayout::push<unsigned char>(unsigned int coun
     stride += VertexBufferElement::getSizeOfType(GL_UNSIGNED_BYTE) * count;
 }
 
+template<> inline void VertexBufferLayout::push<unsigned short>(unsigned int count) {
+    elements.push_back({GL_UNSIGNED_SHORT, count, GL_TRUE});
+    stride += VertexBufferElement::getSizeOfType(GL_UNSIGNED_SHORT) * count;
+}
+
+template<> inline void VertexBufferLayout::push<short>(unsigned int count) {
+    elements.push_back({GL_SHORT, count, GL_TRUE});
+    stride += VertexBufferElement::getSizeOfType(GL_SHORT) * count;
+}
+
+template<> inline void VertexBufferLayout::push<Half>(unsigned int count) {
+    elements.push_back({GL_HALF_FLOAT, count, GL_FALSE});
+    stride += VertexBufferElement::getSizeOfType(GL_HALF_FLOAT) * count;
+}
+
+// Count is number of components read by shader (4), all of them take single 4 byte value
+template<> inline void VertexBufferLayout::push<PackedNormal>(unsigned int count) {
+    elements.push_back({GL_INT_2_10_10_10_REV, count, GL_TRUE});
+    stride += VertexBufferElement::getSizeOfAttribute(GL_INT_2_10_10_10_REV, count);
+}
+
 
 #endif // __VertexBufferLayout__
@@ -0,0 +1,156 @@
+#ifndef __VertexFormat__
+#define __VertexFormat__
+
+#include <GL/glew.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "glm/glm.hpp"
+
+// One vertex attribute as glVertexAttribPointer needs it
+struct VertexAttribute {
+    GLenum type;
+    unsigned int count;     ///< Components per location, 1 to 4
+    bool normalised;
+    unsigned int offset;    ///< Bytes from start of vertex
+    unsigned int locations; ///< Consecutive locations taken, matrices take one per column
+};
+
+// Maps C++ type of vertex struct member to attribute type, members of any other type fail to compile
+template <typename T>
+struct AttributeTraits {
+    static_assert(sizeof(T) == 0, "Type can't be used as vertex attribute, specialise AttributeTraits for it");
+};
+
+template <GLenum Type, typename Component, unsigned int Count, bool Normalised = false, unsigned int Locations = 1>
+struct AttributeTraitsOf {
+    static constexpr GLenum TYPE = Type;
+    static constexpr unsigned int SIZE = sizeof(Component) * Count * Locations;
+    static constexpr unsigned int COUNT = Count;
+    static constexpr bool NORMALISED = Normalised;
+    static constexpr unsigned int LOCATIONS = Locations;
+};
+
+template <> struct AttributeTraits<float> : AttributeTraitsOf<GL_FLOAT, float, 1> {};
+template <> struct AttributeTraits<glm::vec2> : AttributeTraitsOf<GL_FLOAT, float, 2> {};
+template <> struct AttributeTraits<glm::vec3> : AttributeTraitsOf<GL_FLOAT, float, 3> {};
+template <> struct AttributeTraits<glm::vec4> : AttributeTraitsOf<GL_FLOAT, float, 4> {};
+template <> struct AttributeTraits<glm::mat4> : AttributeTraitsOf<GL_FLOAT, float, 4, false, 4> {};
+template <> struct AttributeTraits<unsigned int> : AttributeTraitsOf<GL_UNSIGNED_INT, unsigned int, 1> {};
+// Colours, 0-255 read as 0-1 in shader
+template <> struct AttributeTraits<glm::u8vec4> : AttributeTraitsOf<GL_UNSIGNED_BYTE, unsigned char, 4, true> {};
+// Quantized values, 0-65535 read as 0-1 in shader, see VertexPacking
+template <> struct AttributeTraits<glm::u16vec2> : AttributeTraitsOf<GL_UNSIGNED_SHORT, unsigned short, 2, true> {};
+template <> struct AttributeTraits<glm::u16vec4> : AttributeTraitsOf<GL_UNSIGNED_SHORT, unsigned short, 4, true> {};
+
+// All components packed into one Storage value, e.g. GL_INT_2_10_10_10_REV
+template <GLenum Type, typename Storage, unsigned int Count, bool Normalised>
+struct PackedAttributeTraitsOf {
+    static constexpr GLenum TYPE = Type;
+    static constexpr unsigned int SIZE = sizeof(Storage);
+    static constexpr unsigned int COUNT = Count;
+    static constexpr bool NORMALISED = Normalised;
+    static constexpr unsigned int LOCATIONS = 1;
+};
+
+// Member of type T placed Offset bytes into vertex struct, use through VERTEX_MEMBER
+template <typename T, unsigned int Offset>
+struct VertexMember {
+    using Traits = AttributeTraits<T>;
+    static_assert(Traits::SIZE == sizeof(T),
+            "Attribute traits don't describe whole member");
+
+    static constexpr unsigned int SIZE = sizeof(T);
+
+    static constexpr VertexAttribute describe() {
+        return {Traits::TYPE, Traits::COUNT, Traits::NORMALISED, Offset, Traits::LOCATIONS};
+    }
+};
+
+#define VERTEX_MEMBER(Struct, member) VertexMember<decltype(Struct::member), offsetof(Struct, member)>
+
+// Non owning description of a format, e.g. to pass VertexFormat into functions which are not templates
+struct VertexFormatView {
+    const VertexAttribute* attributes;
+    unsigned int attributeCount;
+    unsigned int stride;
+    uint64_t hash;
+
+    unsigned int getLocationCount() const {
+        unsigned int count = 0;
+        for (unsigned int i = 0; i < attributeCount; i++)
+            count += attributes[i].locations;
+        return count;
+    }
+};
+
+// FNV-1a step over 8 bytes of value
+constexpr uint64_t hashMix(uint64_t hash, uint64_t value) {
+    for (unsigned int i = 0; i < 8; i++) {
+        hash = (hash ^ (value & 0xFF)) * 1099511628211ull;
+        value >>= 8;
+    }
+    return hash;
+}
+
+// FNV-1a over every attribute field and stride
+constexpr uint64_t hashVertexFormat(const VertexAttribute* attributes, unsigned int count, unsigned int stride) {
+    uint64_t hash = 14695981039346656037ull;
+    for (unsigned int i = 0; i < count; i++) {
+        hash = hashMix(hash, attributes[i].type);
+        hash = hashMix(hash, attributes[i].count);
+        hash = hashMix(hash, attributes[i].normalised);
+        hash = hashMix(hash, attributes[i].offset);
+        hash = hashMix(hash, attributes[i].locations);
+    }
+    return hashMix(hash, stride);
+}
+
+// Formats of vertex streams bound together, single stream hashes same as its format
+inline uint64_t hashVertexStreams(const std::vector<VertexFormatView>& streams) {
+    if (streams.size() == 1)
+        return streams[0].hash;
+    uint64_t hash = 14695981039346656037ull;
+    for (const VertexFormatView& stream : streams)
+        hash = hashMix(hash, stream.hash);
+    return hash;
+}
+
+template <typename... Members>
+struct MembersSize;
+
+template <>
+struct MembersSize<> {
+    static constexpr unsigned int VALUE = 0;
+};
+
+template <typename First, typename... Rest>
+struct MembersSize<First, Rest...> {
+    static constexpr unsigned int VALUE = First::SIZE + MembersSize<Rest...>::VALUE;
+};
+
+// Layout of vertex struct known at compile time, for example:
+//   using MeshVertexFormat = VertexFormat<Vertex, VERTEX_MEMBER(Vertex, Position), VERTEX_MEMBER(Vertex, Normal)>;
+// Attributes get consecutive locations in order of the list, stride is size of the struct.
+// Every member must be listed, so forgotten member or padding does not compile
+template <typename VertexType, typename... Members>
+struct VertexFormat {
+    static_assert(sizeof...(Members) > 0, "Vertex format needs at least one attribute");
+    static_assert(MembersSize<Members...>::VALUE == sizeof(VertexType),
+            "Attributes don't cover whole vertex struct, member missing or struct has padding");
+
+    static constexpr unsigned int STRIDE = sizeof(VertexType);
+    static constexpr unsigned int ATTRIBUTE_COUNT = sizeof...(Members);
+    static constexpr VertexAttribute ATTRIBUTES[ATTRIBUTE_COUNT] = {Members::describe()...};
+    static constexpr uint64_t HASH = hashVertexFormat(ATTRIBUTES, ATTRIBUTE_COUNT, STRIDE);
+
+    static constexpr VertexFormatView view() {
+        return {ATTRIBUTES, ATTRIBUTE_COUNT, STRIDE, HASH};
+    }
+};
+
+template <typename VertexType, typename... Members>
+constexpr VertexAttribute VertexFormat<VertexType, Members...>::ATTRIBUTES[];
+
+#endif // __VertexFormat__
@@ -0,0 +1,82 @@
+#include "VertexPacking.hpp"
+
+#include "glm/gtc/packing.hpp"
+#include "glm/gtc/matrix_transform.hpp"
+
+namespace {
+    // Zero scale (flat mesh along an axis) quantizes to 0 and dequantizes back to offset
+    float quantize(float value, float offset, float scale) {
+        return scale > 0.0f ? (value - offset) / scale : 0.0f;
+    }
+}
+
+glm::mat4 VertexQuantization::getPositionTransform() const {
+    return glm::scale(glm::translate(glm::mat4(1.0f), positionOffset), positionScale);
+}
+
+VertexQuantization VertexPacking::computeQuantization(const std::vector<Vertex>& vertices) {
+    VertexQuantization quantization;
+    if (vertices.empty())
+        return quantization;
+
+    glm::vec3 minPosition = vertices[0].Position, maxPosition = vertices[0].Position;
+    glm::vec2 minTexCoords = vertices[0].TexCoords, maxTexCoords = vertices[0].TexCoords;
+    for (const Vertex& vertex : vertices) {
+        minPosition = glm::min(minPosition, vertex.Position);
+        maxPosition = glm::max(maxPosition, vertex.Position);
+        minTexCoords = glm::min(minTexCoords, vertex.TexCoords);
+        maxTexCoords = glm::max(maxTexCoords, vertex.TexCoords);
+    }
+    quantization.positionOffset = minPosition;
+    quantization.positionScale = maxPosition - minPosition;
+    quantization.texCoordOffset = minTexCoords;
+    quantization.texCoordScale = maxTexCoords - minTexCoords;
+    return quantization;
+}
+
+std::vector<PackedVertex> VertexPacking::pack(const std::vector<Vertex>& vertices, const VertexQuantization& quantization) {
+    std::vector<PackedVertex> packed(vertices.size());
+    for (unsigned int i = 0; i < vertices.size(); i++) {
+        const Vertex& vertex = vertices[i];
+        for (int axis = 0; axis < 3; axis++) {
+            packed[i].Position[axis] = glm::packUnorm1x16(quantize(vertex.Position[axis],
+                        quantization.positionOffset[axis], quantization.positionScale[axis]));
+        }
+        packed[i].Position.w = 0;
+        packed[i].Normal = packNormal(vertex.Normal);
+        for (int axis = 0; axis < 2; axis++) {
+            packed[i].TexCoords[axis] = glm::packUnorm1x16(quantize(vertex.TexCoords[axis],
+                        quantization.texCoordOffset[axis], quantization.texCoordScale[axis]));
+        }
+    }
+    return packed;
+}
+
+Vertex VertexPacking::unpack(const PackedVertex& vertex, const VertexQuantization& quantization) {
+    Vertex unpacked;
+    for (int axis = 0; axis < 3; axis++) {
+        unpacked.Position[axis] = quantization.positionOffset[axis]
+            + quantization.positionScale[axis] * glm::unpackUnorm1x16(vertex.Position[axis]);
+    }
+    unpacked.Normal = unpackNormal(vertex.Normal);
+    for (int axis = 0; axis < 2; axis++) {
+        unpacked.TexCoords[axis] = quantization.texCoordOffset[axis]
+            + quantization.texCoordScale[axis] * glm::unpackUnorm1x16(vertex.TexCoords[axis]);
+    }
+    return unpacked;
+}
+
+PackedNormal VertexPacking::packNormal(const glm::vec3& normal) {
+    // GL 3.3 maps signed normalised values slightly differently than 4.2+ (c / 511), difference stays under 0.002
+    float length = glm::length(normal);
+    glm::vec3 unit = length > 0.0f ? normal / length : normal;
+    return {glm::packSnorm3x10_1x2(glm::vec4(unit, 0.0f))};
+}
+
+glm::vec3 VertexPacking::unpackNormal(PackedNormal normal) {
+    return glm::vec3(glm::unpackSnorm3x10_1x2(normal.bits));
+}
+
+Half VertexPacking::packHalf(float value) {
+    return {glm::packHalf1x16(value)};
+}
@@ -0,0 +1,62 @@
+#ifndef __VertexPacking__
+#define __VertexPacking__
+
+#include <vector>
+#include <cstdint>
+
+#include "Vertex.hpp"
+
+// Half precision float as stored in GL_HALF_FLOAT attributes
+struct Half {
+    uint16_t bits;
+};
+
+// Unit vector in GL_INT_2_10_10_10_REV: x, y and z as 10 bit signed normalised values, 2 bits of w unused
+struct PackedNormal {
+    uint32_t bits;
+};
+
+template <> struct AttributeTraits<PackedNormal> : PackedAttributeTraitsOf<GL_INT_2_10_10_10_REV, uint32_t, 4, true> {};
+
+// 16 bytes instead of 32 of Vertex. Shader reads position and texture coords as 0-1 values inside mesh bounds,
+// VertexQuantization of the mesh maps them back
+struct PackedVertex {
+    glm::u16vec4 Position;  ///< Unorm16 inside position bounds, w unused, keeps normal 4 byte aligned
+    PackedNormal Normal;
+    glm::u16vec2 TexCoords; ///< Unorm16 inside texture coord bounds
+};
+
+using PackedVertexFormat = VertexFormat<PackedVertex,
+      VERTEX_MEMBER(PackedVertex, Position),
+      VERTEX_MEMBER(PackedVertex, Normal),
+      VERTEX_MEMBER(PackedVertex, TexCoords)>;
+
+// Per mesh dequantization: value = offset + scale * quantized, quantized being 0-1 as read by shader
+struct VertexQuantization {
+    glm::vec3 positionOffset = glm::vec3(0.0f);
+    glm::vec3 positionScale = glm::vec3(1.0f);
+    glm::vec2 texCoordOffset = glm::vec2(0.0f);
+    glm::vec2 texCoordScale = glm::vec2(1.0f);
+
+    // Maps quantized position to model space, so it can be folded into model matrix at no cost in shader
+    glm::mat4 getPositionTransform() const;
+    // Offset in xy, scale in zw, for single vec4 uniform
+    glm::vec4 getTexCoordTransform() const { return glm::vec4(texCoordOffset, texCoordScale); }
+};
+
+// Encoders used at import time, meant for static meshes: positions get uniform precision of bounds / 65535
+// along each axis, normals about 0.1 degree, texture coords bounds / 65535
+class VertexPacking {
+    public:
+        // Bounds of positions and texture coords of all vertices
+        static VertexQuantization computeQuantization(const std::vector<Vertex>& vertices);
+        static std::vector<PackedVertex> pack(const std::vector<Vertex>& vertices, const VertexQuantization& quantization);
+        // Inverse of pack(), e.g. to measure error introduced by quantization
+        static Vertex unpack(const PackedVertex& vertex, const VertexQuantization& quantization);
+
+        static PackedNormal packNormal(const glm::vec3& normal);
+        static glm::vec3 unpackNormal(PackedNormal normal);
+        static Half packHalf(float value);
+};
+
+#endif // __VertexPacking__
@@ -8,6 +8,16 @@
 
 #include <iostream>
 #include "Renderer.hpp"
+#include "GLState.hpp"
+#include "GLDebug.hpp"
+#include "GPUProfiler.hpp"
+#include "CPUProfiler.hpp"
+#include "Benchmark.hpp"
+#include "GeometryPool.hpp"
+#include "UploadQueue.hpp"
+#include "DeletionQueue.hpp"
+#include "ProgramCache.hpp"
+#include "FrameUniforms.hpp"
 #include "VertexBuffer.hpp"
 #include "VertexBufferLayout.hpp"
 #include "Texture.hpp"
@@ -36,6 +46,7 @@
 #include "tests/TestFramebuffers.hpp"
 #include "tests/TestCubemaps.hpp"
 #include "tests/TestInstancing.hpp"
+#include "tests/TestPackedVertices.hpp"
 
 float lastX, lastY;
 bool firstMouse;
@@ -117,9 +128,13 @@ void processInput(GLFWwindow* window, Camera* camera, float deltaTime) {
     }
 }
 
-int main(void) {
+int main(int argc, char** argv) {
     GLFWwindow* window;
 
+    BenchmarkOptions benchmarkOptions;
+    if (!Benchmark::parseArguments(argc, argv, benchmarkOptions))
+        return -1;
+
     /* Initialize the library */
     if (!glfwInit())
         return -1;
@@ -128,6 +143,12 @@ int main(void) {
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+#ifdef DEBUG
+    glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GLFW_TRUE);
+#elif defined(GL_NO_ERROR_CONTEXT)
+    // Driver is allowed to skip all error checking, only use once build is known to be free of GL errors
+    glfwWindowHint(GLFW_CONTEXT_NO_ERROR, GLFW_TRUE);
+#endif
 
     // Defaults
     int screenWidth = 1920;
@@ -135,14 +156,22 @@ int main(void) {
 
     GLFWmonitor* monitor = nullptr;
 
-    // Block below is responsible for setting up fullscreen
-    monitor = glfwGetPrimaryMonitor();
-    const GLFWvidmode* mode = glfwGetVideoMode(monitor);
-    glfwWindowHint(GLFW_GREEN_BITS, mode->greenBits);
-    glfwWindowHint(GLFW_BLUE_BITS, mode->blueBits);
-    glfwWindowHint(GLFW_REFRESH_RATE, mode->refreshRate);
-    screenWidth = mode->width;
-    screenHeight = mode->height;
+    if (benchmarkOptions.enabled) {
+        // Benchmarks render into invisible window of requested size, so they don't need monitor at all
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+        screenWidth = benchmarkOptions.width;
+        screenHeight = benchmarkOptions.height;
+    } else {
+        // Block below is responsible for setting up fullscreen
+        monitor = glfwGetPrimaryMonitor();
+        const GLFWvidmode* mode = glfwGetVideoMode(monitor);
+        glfwWindowHint(GLFW_GREEN_BITS, mode->greenBits);
+        glfwWindowHint(GLFW_BLUE_BITS, mode->blueBits);
+        glfwWindowHint(GLFW_REFRESH_RATE, mode->refreshRate);
+        screenWidth = mode->width;
+        screenHeight = mode->height;
+    }
+    test::Test::setScreenSize(screenWidth, screenHeight);
 
     // Monitor will be nullptr for non-fullscreen
     window = glfwCreateWindow(screenWidth, screenHeight, "OpenGL test", monitor, NULL);
@@ -165,11 +194,15 @@ int main(void) {
     lastY = screenHeight / 2.0f;
     firstMouse = true;
 
-    glfwSwapInterval(1); // Enable vsync
+    // Enable vsync, unless benchmarking
+    glfwSwapInterval(benchmarkOptions.enabled ? 0 : 1);
 
     if (glewInit() != GLEW_OK) {
         std::cout << "Coult not initialise Glew!" << std::endl;
     }
+    GLDebug::init();
+    ProgramCache::init(benchmarkOptions.shaderCacheDir);
+    Shader::init();
 
     // imgui gl context
     IMGUI_CHECKVERSION();
@@ -225,14 +258,30 @@ int main(void) {
     testMenu->registerTest<test::TestFramebuffers>("Framebuffers");
     testMenu->registerTest<test::TestCubemaps>("Cubemap textures");
     testMenu->registerTest<test::TestInstancing>("Instanced drawing");
+    testMenu->registerTest<test::TestPackedVertices>("Vertex formats and streams");
+
+    int exitCode = 0;
+    if (benchmarkOptions.enabled)
+        exitCode = Benchmark(benchmarkOptions).run(window, *testMenu);
 
     /* Loop until the user closes the window */
-    while (!glfwWindowShouldClose(window)) {
+    while (!benchmarkOptions.enabled && !glfwWindowShouldClose(window)) {
 
+        CPUProfiler::beginScope("Frame");
         float currentFrame = static_cast<float>(glfwGetTime());
         deltaTime = currentFrame - lastFrame;
         lastFrame = currentFrame;
+        CPUProfiler::beginScope("processInput");
         processInput(window, camera, deltaTime);
+        CPUProfiler::endScope();
+        GLState::newFrame();
+        VertexBuffer::newFrame();
+        DeletionQueue::newFrame();
+        GPUProfiler::beginFrame();
+        // Resources created last frame (e.g. by newly opened test) get their data before anything draws
+        CPUProfiler::beginScope("UploadQueue::flush");
+        UploadQueue::flush();
+        CPUProfiler::endScope();
 
         ImGui_ImplOpenGL3_NewFrame();
         ImGui_ImplGlfw_NewFrame();
@@ -247,9 +296,20 @@ int main(void) {
             // so for now I will let this slide
             // Why does this break batch tests??? They aren't even using camera, WTF
             currentTest->setCamera(camera);
+            CPUProfiler::beginScope("Test::processInput");
             currentTest->processInput(window, deltaTime);
+            CPUProfiler::endScope();
+            CPUProfiler::beginScope("Test::onUpdate");
             currentTest->onUpdate(deltaTime);
+            CPUProfiler::endScope();
+            CPUProfiler::beginScope("Test::onRender");
+            GPUProfiler::beginScope("Test::onRender");
             currentTest->onRender();
+            // Issue any queued draws test did not flush itself
+            renderer.flush();
+            GPUProfiler::endScope();
+            CPUProfiler::endScope();
+            CPUProfiler::beginScope("Test::onImGuiRender");
             ImGui::Begin("Test");
             if (currentTest != testMenu && ImGui::Button("<-")) {
                 delete currentTest;
@@ -266,6 +326,17 @@ int main(void) {
             ImGui::Checkbox("Wireframe mode", &wireframe_mode);
             ImGui::Checkbox("Demo Window", &show_demo_window);
             ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.0f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
+            ImGui::Text("GL binds per frame: %u issued, %u skipped", GLState::getBindsIssued(), GLState::getBindsSkipped());
+            ImGui::Text("Vertex uploads per frame: %.1f KB in %u calls", VertexBuffer::getBytesUploaded() / 1024.0f,
+                    VertexBuffer::getUploadCalls());
+            ImGui::Text("Upload queue: %.1f KB this frame, %.1f KB pending in %u uploads", UploadQueue::getBytesUploaded() / 1024.0f,
+                    UploadQueue::getPendingBytes() / 1024.0f, UploadQueue::getPendingCount());
+            ImGui::Text("Deferred deletes: %u pending, %u deleted this frame", DeletionQueue::getPendingCount(),
+                    DeletionQueue::getDeletedCount());
+            ImGui::Text("Programs: %u from binary cache, %u compiled, %u compiling, %u binaries rejected%s",
+                    ProgramCache::getLoadedCount(), ProgramCache::getCompiledCount(), Shader::getCompilingCount(),
+                    ProgramCache::getRejectedCount(),
+                    ProgramCache::isEnabled() ? "" : " (cache disabled)");
             if(ImGui::Button("Close Application"))
                 glfwSetWindowShouldClose(window, 1);
             ImGui::Separator();
@@ -273,18 +344,33 @@ int main(void) {
             ImGui::Text("C - toggle cursor");
 
             ImGui::End();
+
+            GPUProfiler::onImGuiRender();
+            CPUProfiler::onImGuiRender();
+            GeometryPool::onImGuiRender();
+            CPUProfiler::endScope();
         }
 
         if (show_demo_window)
             ImGui::ShowDemoWindow(&show_demo_window);
 
+        CPUProfiler::beginScope("ImGui::Render");
         ImGui::Render();
+        GPUProfiler::beginScope("ImGui");
         ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+        GPUProfiler::endScope();
+        CPUProfiler::endScope();
+        GPUProfiler::endFrame();
         /* Swap front and back buffers */
+        CPUProfiler::beginScope("glfwSwapBuffers");
         glfwSwapBuffers(window);
+        CPUProfiler::endScope();
 
         /* Poll for and process events */
+        CPUProfiler::beginScope("glfwPollEvents");
         glfwPollEvents();
+        CPUProfiler::endScope();
+        CPUProfiler::endScope();
     }
 
     delete camera;
@@ -301,6 +387,12 @@ int main(void) {
     // currently they are allocated on stack and this causes program to hand due to gl get error loop
     // complaining about no context
 
+    // Pools own GL buffers, so they must go while context still exists
+    GeometryPool::destroyAll();
+    Renderer::clearVertexArrayCache();
+    FrameUniforms::shutdown();
+    UploadQueue::shutdown();
+    DeletionQueue::shutdown();
     glfwTerminate();
-    return 0;
+    return exitCode;
 }
@@ -1,9 +1,13 @@
 #include "Test.hpp"
 
 #include "imgui/imgui.h"
+#include "../CPUProfiler.hpp"
 
 namespace test {
 
+    int Test::screenSizeWidth = 1920;
+    int Test::screenSizeHeight = 1080;
+
     TestMenu::TestMenu(Test*& currentTestPointer): currentTest(currentTestPointer) {
     }
 
@@ -11,9 +15,26 @@ namespace test {
         for (auto& test: tests) {
             if (ImGui::Button(test.first.c_str())) {
                 // If button gets clicked, lambda in tests vector gets exectued creating new test
+                PROFILE_SCOPE("TestMenu::createTest");
                 currentTest = test.second();
             }
         }
     }
+
+    Test* TestMenu::createTest(const std::string& name) {
+        for (auto& test: tests) {
+            if (test.first == name)
+                return test.second();
+        }
+        return nullptr;
+    }
+
+    std::vector<std::string> TestMenu::getTestNames() const {
+        std::vector<std::string> names;
+        for (auto& test: tests) {
+            names.push_back(test.first);
+        }
+        return names;
+    }
 }
 
@@ -24,6 +24,15 @@ namespace test {
 
             void setCamera(Camera* cam) { camera = cam; }
             Camera* camera;
+
+            // Size of default framebuffer, set by main before any test is created,
+            // so tests don't depend on having a monitor (benchmark runs in invisible window)
+            static void setScreenSize(int width, int height) { screenSizeWidth = width; screenSizeHeight = height; }
+            static int getScreenWidth() { return screenSizeWidth; }
+            static int getScreenHeight() { return screenSizeHeight; }
+        private:
+            static int screenSizeWidth;
+            static int screenSizeHeight;
     };
 
     class TestMenu : public Test {
@@ -36,6 +45,10 @@ namespace test {
                 std::cout << "Registering test " << name << std::endl;
                 tests.push_back(std::make_pair(name, [](){ return new T(); } ));
             }
+
+            // Creates registered test by its name, returns nullptr if there is no such test
+            Test* createTest(const std::string& name);
+            std::vector<std::string> getTestNames() const;
         private:
             Test*& currentTest;
             std::vector<std::pair<std::string, std::function<Test*()>>> tests;
@@ -16,16 +16,8 @@ namespace test {
         : translation(0, 0, 0),
         cameraTranslation(0, 0, -1), cameraRotation(0, 0, 0) ,scale(1.0), rotation(45.0f) {
 
-        // TODO: pass screen coords in instead of creating these raw pointers here
-        // to get screen measurements
-        GLFWmonitor* monitor = glfwGetPrimaryMonitor();
-        const GLFWvidmode* mode = glfwGetVideoMode(monitor);
-
-        screenWidth = mode->width;
-        screenHeight = mode->height;
-
-        //free(monitor);
-        //free(mode);
+        screenWidth = getScreenWidth();
+        screenHeight = getScreenHeight();
 
         // We render 2 quads using batch rendering - all vertices defined in vbo
         // 1,2,3 - positions, 3,4 - tex coords, 5,6,7,8 - color, 9 - texture slot id
@@ -87,21 +79,13 @@ namespace test {
         // Generate and bind index buffer object
         ibo = std::make_unique<IndexBuffer>(indices, 12);
 
+        // Program is linked in background, uniforms are set once it is ready (see onRender)
         shader = std::make_unique<Shader>("assets/shaders/batch.glsl");
-        shader->bind();
-        shader->setUniform4f("u_Color", 0.8f, 0.3f, 0.8f, 1.0f);
-
-        auto loc = glGetUniformLocation(shader->getRendererID(), "u_textures");
-        int samplers[2] = {0, 1};
-        glUniform1iv(loc, 2, samplers);
-
 
         texture = std::make_unique<Texture>("assets/textures/slime.png");
         texture2 = std::make_unique<Texture>("assets/textures/mountains.png");
         texture->bind(); // bound to default slot 0
         texture2->bind(1);
-        // Set uniform to tell shader that we need to sample texture from slot 0
-        shader->setUniform1i("u_Texture", 0);
 
         glDisable(GL_DEPTH_TEST);
 
@@ -116,6 +100,9 @@ namespace test {
     void TestBatchRendering::onRender() {
         GLCall(glClearColor(0.0f, 0.0f, 0.0f, 1.0f));
         GLCall(glClear(GL_COLOR_BUFFER_BIT));
+        // Binding would wait for the compiler
+        if (!shader->isReady())
+            return;
 
         texture->bind(); // bound to default slot 0
         texture2->bind(1);
@@ -140,8 +127,13 @@ namespace test {
         Renderer renderer;
 
         shader->bind();
-        shader->setUniform4f("u_Color", 0.5f, 0.3f, 0.8f, 1.0f);
-        shader->setUniformMat4f("u_MVP", mvp);
+        auto loc = glGetUniformLocation(shader->getRendererID(), "u_textures");
+        int samplers[2] = {0, 1};
+        glUniform1iv(loc, 2, samplers);
+        // Set uniform to tell shader that we need to sample texture from slot 0
+        shader->setUniform1i(UNIFORM("u_Texture"), 0);
+        shader->setUniform4f(UNIFORM("u_Color"), 0.5f, 0.3f, 0.8f, 1.0f);
+        shader->setUniformMat4f(UNIFORM("u_MVP"), mvp);
         renderer.draw(*vao, *ibo, *shader);
     }
 
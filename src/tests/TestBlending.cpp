@@ -1,13 +1,13 @@
 #include "TestBlending.hpp"
 
 #include "../Renderer.hpp"
+#include "../FrameUniforms.hpp"
 
 #include "glm/gtc/matrix_transform.hpp"
 
 // For glm::to_string()
 #include "glm/gtx/string_cast.hpp"
 #include <iostream>
-#include <map>
 
 #include "imgui/imgui.h"
 
@@ -16,13 +16,8 @@
 namespace test {
 
     TestBlending::TestBlending() {
-        // TODO: pass screen coords in instead of creating these raw pointers here
-        // to get screen measurements
-        GLFWmonitor* monitor = glfwGetPrimaryMonitor();
-        const GLFWvidmode* mode = glfwGetVideoMode(monitor);
-
-        screenWidth = mode->width;
-        screenHeight = mode->height;
+        screenWidth = getScreenWidth();
+        screenHeight = getScreenHeight();
 
         glEnable(GL_DEPTH_TEST);
         glDepthFunc(GL_LESS);
@@ -132,19 +127,16 @@ namespace test {
         floorIbo = std::make_unique<IndexBuffer>(floorIndices, 6);
 
 
+        // Programs are linked in background, samplers are set once they are ready (see onRender)
         objectShader = std::make_unique<Shader>("assets/shaders/lightCasters.glsl");
-        objectShader->bind();
 
         diffuseMap = std::make_unique<Texture>("assets/textures/container.png");
         specularMap = std::make_unique<Texture>("assets/textures/container_specular.png");
 	// Bind both maps to different slots and set uniforms
         diffuseMap->bind();
 	specularMap->bind(1);
-        objectShader->setUniform1i("material.diffuseMap", 0);
-        objectShader->setUniform1i("material.specularMap", 1);
 
         blendShader = std::make_unique<Shader>("assets/shaders/mvp.vert", "assets/shaders/blending.frag");
-        blendShader->bind();
 
         grassTexture = std::make_unique<Texture>("assets/textures/grass.png");
         windowTexture = std::make_unique<Texture>("assets/textures/blending_transparent_window.png");
@@ -178,6 +170,9 @@ namespace test {
     void TestBlending::onRender() {
 
         GLCall(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT));
+        // Binding would wait for the compiler
+        if (!objectShader->isReady() || !blendShader->isReady() || !lightSourceShader->isReady())
+            return;
 
         diffuseMap->bind(); // bound to default slot 0
 	specularMap->bind(1);
@@ -212,87 +207,96 @@ namespace test {
         windows.push_back(glm::vec3(-2.3f, 2.5f, -2.3f));
         windows.push_back(glm::vec3(-1.5f, 2.5f, -0.6f));
 
-        // To solve transparency issues with multiple transparent textures one way is to
-        // order them and draw from farest to the nearest
-        std::map<float, glm::vec3> sortedObjects;
-        for (unsigned int i = 0; i < windows.size(); i++) {
-            float distance= glm::length(camera->Position - windows[i]);
-            sortedObjects[distance] = windows[i];
-        }
-
         Renderer renderer;
 
         objectShader->bind();
-        objectShader->setUniform1f("material.shininess", 32.0f);
-
-        objectShader->setUniformVec3("dirLight.direction", lightDirection);
-        objectShader->setUniformVec3("dirLight.ambient", dirLightColor * glm::vec3(0.1f));
-        objectShader->setUniformVec3("dirLight.diffuse", dirLightColor * glm::vec3(0.5f));
-        objectShader->setUniform3f("dirLight.specular", 1.0f, 1.0f, 1.0f);
-
-        objectShader->setUniformVec3("pointLight.position", lightPosition);
-        objectShader->setUniformVec3("pointLight.ambient", pointLightColor * glm::vec3(0.1f));
-        objectShader->setUniformVec3("pointLight.diffuse", pointLightColor * glm::vec3(0.2f));
-        objectShader->setUniform3f("pointLight.specular", 1.0f, 1.0f, 1.0f);
-        objectShader->setUniform1f("pointLight.constant", constant);
-        objectShader->setUniform1f("pointLight.linear", linear);
-        objectShader->setUniform1f("pointLight.quadratic", quadratic);
+        objectShader->setUniform1i(UNIFORM("material.diffuseMap"), 0);
+        objectShader->setUniform1i(UNIFORM("material.specularMap"), 1);
+        objectShader->setUniform1f(UNIFORM("material.shininess"), 32.0f);
+
+        LightConstants lights = {};
+        lights.dirLight.direction = lightDirection;
+        lights.dirLight.ambient = dirLightColor * glm::vec3(0.1f);
+        lights.dirLight.diffuse = dirLightColor * glm::vec3(0.5f);
+        lights.dirLight.specular = glm::vec3(1.0f);
+
+        lights.pointLight.position = lightPosition;
+        lights.pointLight.ambient = pointLightColor * glm::vec3(0.1f);
+        lights.pointLight.diffuse = pointLightColor * glm::vec3(0.2f);
+        lights.pointLight.specular = glm::vec3(1.0f);
+        lights.pointLight.constant = constant;
+        lights.pointLight.linear = linear;
+        lights.pointLight.quadratic = quadratic;
 
         // Make spot light position same as camera thus simulating flashlight!
-        objectShader->setUniformVec3("spotLight.position", camera->Position);
-        objectShader->setUniformVec3("spotLight.direction", camera->Front);
-        objectShader->setUniform1f("spotLight.cutOff", glm::cos(glm::radians(12.5f)));
-        objectShader->setUniform1f("spotLight.outerCutOff", glm::cos(glm::radians(17.5f)));
-        objectShader->setUniformVec3("spotLight.ambient", spotLightColor * glm::vec3(0.2f));
-        objectShader->setUniformVec3("spotLight.diffuse", spotLightColor * glm::vec3(0.9f));
-        objectShader->setUniform3f("spotLight.specular", 1.0f, 1.0f, 1.0f);
-
-        objectShader->setUniformVec3("viewPosition", camera->Position);
-
-        objectShader->setUniformMat4f("projection", proj);
-        objectShader->setUniformMat4f("view", view);
+        lights.spotLight.position = camera->Position;
+        lights.spotLight.direction = camera->Front;
+        lights.spotLight.cutOff = glm::cos(glm::radians(12.5f));
+        lights.spotLight.outerCutOff = glm::cos(glm::radians(17.5f));
+        lights.spotLight.ambient = spotLightColor * glm::vec3(0.2f);
+        lights.spotLight.diffuse = spotLightColor * glm::vec3(0.9f);
+        lights.spotLight.specular = glm::vec3(1.0f);
+
+        // Uploaded once, seen by every shader declaring LightConstants and FrameConstants blocks
+        FrameUniforms::setLights(lights);
+        FrameUniforms::setFrame(proj, view, camera->Position);
+
+        // Opaque objects share same shader and textures, queue will group them together
+        RenderCommand command;
+        command.shader = objectShader.get();
+        command.textures[0] = diffuseMap.get();
+        command.textures[1] = specularMap.get();
+        command.modelUniform = objectShader->getUniform<glm::mat4>(UNIFORM("model"));
 
         // Render floor
         model = glm::translate(glm::mat4(1.0f), cubePositions[0]);
         model = glm::scale(model, glm::vec3(5.0f, 1.0f, 5.0f));
-        objectShader->setUniformMat4f("model", model);
-        renderer.draw(*floorVao, *floorIbo, *objectShader);
+        command.va = floorVao.get();
+        command.ib = floorIbo.get();
+        command.model = model;
+        command.depth = glm::length(camera->Position - cubePositions[0]);
+        renderer.submit(command);
 
         // Render containers
+        command.va = vao.get();
+        command.ib = ibo.get();
         for (unsigned int i = 0; i < 3; i++) {
-            model = glm::translate(glm::mat4(1.0f), cubePositions[i]);
-            objectShader->setUniformMat4f("model", model);
-            renderer.draw(*vao, *ibo, *objectShader);
+            command.model = glm::translate(glm::mat4(1.0f), cubePositions[i]);
+            command.depth = glm::length(camera->Position - cubePositions[i]);
+            renderer.submit(command);
         }
 
         //Render grass
         grassTexture->bind();
         blendShader->bind();
-        blendShader->setUniform1i("texture1", 0);
-        blendShader->setUniformMat4f("projection", proj);
-        blendShader->setUniformMat4f("view", view);
+        blendShader->setUniform1i(UNIFORM("texture1"), 0);
         for (unsigned int i = 0; i < vegetation.size(); i++) {
             model = glm::translate(glm::mat4(1.0f), vegetation[i]);
             model = glm::rotate(model, glm::radians(90.0f), glm::vec3(0.0, 0.0, 1.0));
-            blendShader->setUniformMat4f("model", model);
+            blendShader->setUniformMat4f(UNIFORM("model"), model);
             //renderer.draw(*floorVao, *floorIbo, *blendShader);
         }
 
         //Render windows
-        windowTexture->bind();
+        // To solve transparency issues with multiple transparent textures they must be drawn
+        // from farest to the nearest, transparent pass of render queue takes care of that
         blendShader->bind();
-        blendShader->setUniform1i("texture1", 0);
-        blendShader->setUniformMat4f("projection", proj);
-        blendShader->setUniformMat4f("view", view);
-        //for (unsigned int i = 0; i < windows.size(); i++) {
-        for (std::map<float, glm::vec3>::reverse_iterator it = sortedObjects.rbegin(); it != sortedObjects.rend(); ++it) {
-            //model = glm::translate(glm::mat4(1.0f), windows[i]);
-            model = glm::translate(glm::mat4(1.0f), it->second);
+        blendShader->setUniform1i(UNIFORM("texture1"), 0);
+        RenderCommand windowCommand;
+        windowCommand.va = floorVao.get();
+        windowCommand.ib = floorIbo.get();
+        windowCommand.shader = blendShader.get();
+        windowCommand.textures[0] = windowTexture.get();
+        windowCommand.modelUniform = blendShader->getUniform<glm::mat4>(UNIFORM("model"));
+        windowCommand.pass = RenderPass::TRANSPARENT_PASS;
+        for (unsigned int i = 0; i < windows.size(); i++) {
+            model = glm::translate(glm::mat4(1.0f), windows[i]);
             model = glm::scale(model, glm::vec3(0.5f, 0.5f, 0.5f));
             model = glm::rotate(model, glm::radians(90.0f), glm::vec3(0.0, 0.0, 1.0));
             model = glm::rotate(model, glm::radians(90.0f), glm::vec3(0.0, 1.0, 0.0));
-            blendShader->setUniformMat4f("model", model);
-            renderer.draw(*floorVao, *floorIbo, *blendShader);
+            windowCommand.model = model;
+            windowCommand.depth = glm::length(camera->Position - windows[i]);
+            renderer.submit(windowCommand);
         }
 
 
@@ -302,9 +306,16 @@ namespace test {
         model = glm::scale(model, glm::vec3(0.5f, 0.5f, 0.5f));
 
         glm::mat4 mvp = proj * view * model;
-        lightSourceShader->setUniformMat4f("u_MVP", mvp);
-        lightSourceShader->setUniform3f("lightColor", pointLightColor.x, pointLightColor.y, pointLightColor.z);
-        renderer.draw(*vao, *ibo, *lightSourceShader);
+        lightSourceShader->setUniformMat4f(UNIFORM("u_MVP"), mvp);
+        lightSourceShader->setUniform3f(UNIFORM("lightColor"), pointLightColor.x, pointLightColor.y, pointLightColor.z);
+        RenderCommand lightCommand;
+        lightCommand.va = vao.get();
+        lightCommand.ib = ibo.get();
+        lightCommand.shader = lightSourceShader.get();
+        lightCommand.depth = glm::length(camera->Position - lightPosition);
+        renderer.submit(lightCommand);
+
+        renderer.flush();
     }
 
     void TestBlending::onImGuiRender() {
@@ -17,13 +17,8 @@ namespace test {
     TestCameraClass::TestCameraClass()
         : translation(0, 0, 0), cameraTranslation(0, 0, 0), scale(0.5), rotation(45.0f) {
 
-        // TODO: pass screen coords in instead of creating these raw pointers here
-        // to get screen measurements
-        GLFWmonitor* monitor = glfwGetPrimaryMonitor();
-        const GLFWvidmode* mode = glfwGetVideoMode(monitor);
-
-        screenWidth = mode->width;
-        screenHeight = mode->height;
+        screenWidth = getScreenWidth();
+        screenHeight = getScreenHeight();
 
         // Enable depth testing
         glEnable(GL_DEPTH_TEST);
@@ -105,13 +100,11 @@ namespace test {
         ibo = std::make_unique<IndexBuffer>(indices, 36);
 
 
+        // Program is linked in background, sampler is set once it is ready (see onRender)
         shader = std::make_unique<Shader>("assets/shaders/cube_textured.glsl");
-        shader->bind();
 
         texture = std::make_unique<Texture>("assets/textures/dirt.png");
         texture->bind(); // bound to default slot 0
-        // Set uniform to tell shader that we need to sample texture from slot 0
-        shader->setUniform1i("u_Texture", 0);
     }
 
     TestCameraClass::~TestCameraClass() {
@@ -123,6 +116,9 @@ namespace test {
     void TestCameraClass::onRender() {
         GLCall(glClearColor(0.0f, 0.0f, 0.0f, 1.0f));
         GLCall(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT));
+        // Binding would wait for the compiler
+        if (!shader->isReady())
+            return;
 
         texture->bind(); // bound to default slot 0
 
@@ -162,8 +158,10 @@ namespace test {
             Renderer renderer;
 
             shader->bind();
-            shader->setUniform4f("u_Color", 1.0f, 0.3f, 0.8f, 1.0f);
-            shader->setUniformMat4f("u_MVP", mvp);
+            // Set uniform to tell shader that we need to sample texture from slot 0
+            shader->setUniform1i(UNIFORM("u_Texture"), 0);
+            shader->setUniform4f(UNIFORM("u_Color"), 1.0f, 0.3f, 0.8f, 1.0f);
+            shader->setUniformMat4f(UNIFORM("u_MVP"), mvp);
             renderer.draw(*vao, *ibo, *shader);
         }
     }
@@ -1,6 +1,7 @@
 #include "TestCubemaps.hpp"
 
 #include "../Renderer.hpp"
+#include "../FrameUniforms.hpp"
 
 #include "glm/gtc/matrix_transform.hpp"
 
@@ -16,13 +17,8 @@
 namespace test {
 
     TestCubemaps::TestCubemaps() {
-        // TODO: pass screen coords in instead of creating these raw pointers here
-        // to get screen measurements
-        GLFWmonitor* monitor = glfwGetPrimaryMonitor();
-        const GLFWvidmode* mode = glfwGetVideoMode(monitor);
-
-        screenWidth = mode->width;
-        screenHeight = mode->height;
+        screenWidth = getScreenWidth();
+        screenHeight = getScreenHeight();
         std::cout << "Screen Width: " << screenWidth << ", Screen Height: " << screenHeight << "\n";
 
         glEnable(GL_DEPTH_TEST);
@@ -126,16 +122,11 @@ namespace test {
         floorVao->addBuffer(*floorVbo, layout);
         floorIbo = std::make_unique<IndexBuffer>(floorIndices, 6);
 
+        // Programs are linked in background, samplers are set once they are ready (see onRender)
         objectShader = std::make_unique<Shader>("assets/shaders/environmentMapping.glsl");
-        objectShader->bind();
 
         diffuseMap = std::make_unique<Texture>("assets/textures/container.png");
         specularMap = std::make_unique<Texture>("assets/textures/container_specular.png");
-	// Bind both maps to different slots and set uniforms
-        objectShader->setUniform1i("material.diffuseMap", 0);
-        objectShader->setUniform1i("material.specularMap", 1);
-        // For environmental mapping (reflections, refractions
-        objectShader->setUniform1i("skybox", 2);
 
         lightSourceShader = std::make_unique<Shader>("assets/shaders/lightSourceVariableColor.glsl");
 
@@ -224,9 +215,6 @@ namespace test {
 
         cubemapTexture = std::make_unique<Texture>(faces);
         cubemapShader = std::make_unique<Shader>("assets/shaders/cubemap.glsl");
-
-        cubemapShader->bind();
-        cubemapShader->setUniform1i("cubemap", 0);
     }
 
     TestCubemaps::~TestCubemaps() {
@@ -239,6 +227,9 @@ namespace test {
     void TestCubemaps::onRender() {
 
         GLCall(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT));
+        // Binding would wait for the compiler
+        if (!objectShader->isReady() || !lightSourceShader->isReady() || !cubemapShader->isReady())
+            return;
 
         diffuseMap->bind(); // bound to default slot 0
 	specularMap->bind(1);
@@ -263,47 +254,52 @@ namespace test {
         Renderer renderer;
 
         objectShader->bind();
-        objectShader->setUniform1f("material.shininess", 32.0f);
-
-        objectShader->setUniformVec3("dirLight.direction", lightDirection);
-        objectShader->setUniformVec3("dirLight.ambient", dirLightColor * glm::vec3(0.1f));
-        objectShader->setUniformVec3("dirLight.diffuse", dirLightColor * glm::vec3(0.5f));
-        objectShader->setUniform3f("dirLight.specular", 1.0f, 1.0f, 1.0f);
-
-        objectShader->setUniformVec3("pointLight.position", lightPosition);
-        objectShader->setUniformVec3("pointLight.ambient", pointLightColor * glm::vec3(0.1f));
-        objectShader->setUniformVec3("pointLight.diffuse", pointLightColor * glm::vec3(0.2f));
-        objectShader->setUniform3f("pointLight.specular", 1.0f, 1.0f, 1.0f);
-        objectShader->setUniform1f("pointLight.constant", constant);
-        objectShader->setUniform1f("pointLight.linear", linear);
-        objectShader->setUniform1f("pointLight.quadratic", quadratic);
+        // Bind both maps to different slots
+        objectShader->setUniform1i(UNIFORM("material.diffuseMap"), 0);
+        objectShader->setUniform1i(UNIFORM("material.specularMap"), 1);
+        // For environmental mapping (reflections, refractions
+        objectShader->setUniform1i(UNIFORM("skybox"), 2);
+        objectShader->setUniform1f(UNIFORM("material.shininess"), 32.0f);
+
+        LightConstants lights = {};
+        lights.dirLight.direction = lightDirection;
+        lights.dirLight.ambient = dirLightColor * glm::vec3(0.1f);
+        lights.dirLight.diffuse = dirLightColor * glm::vec3(0.5f);
+        lights.dirLight.specular = glm::vec3(1.0f);
+
+        lights.pointLight.position = lightPosition;
+        lights.pointLight.ambient = pointLightColor * glm::vec3(0.1f);
+        lights.pointLight.diffuse = pointLightColor * glm::vec3(0.2f);
+        lights.pointLight.specular = glm::vec3(1.0f);
+        lights.pointLight.constant = constant;
+        lights.pointLight.linear = linear;
+        lights.pointLight.quadratic = quadratic;
 
         // Make spot light position same as camera thus simulating flashlight!
-        objectShader->setUniformVec3("spotLight.position", camera->Position);
-        objectShader->setUniformVec3("spotLight.direction", camera->Front);
-        objectShader->setUniform1f("spotLight.cutOff", glm::cos(glm::radians(12.5f)));
-        objectShader->setUniform1f("spotLight.outerCutOff", glm::cos(glm::radians(17.5f)));
-        objectShader->setUniformVec3("spotLight.ambient", spotLightColor * glm::vec3(0.2f));
-        objectShader->setUniformVec3("spotLight.diffuse", spotLightColor * glm::vec3(0.9f));
-        objectShader->setUniform3f("spotLight.specular", 1.0f, 1.0f, 1.0f);
-
-        objectShader->setUniformVec3("viewPosition", camera->Position);
-
-        objectShader->setUniformMat4f("projection", proj);
-        objectShader->setUniformMat4f("view", view);
-
-        objectShader->setUniform1i("reflectOn", reflect);
-        objectShader->setUniform1i("refractOn", refract);
+        lights.spotLight.position = camera->Position;
+        lights.spotLight.direction = camera->Front;
+        lights.spotLight.cutOff = glm::cos(glm::radians(12.5f));
+        lights.spotLight.outerCutOff = glm::cos(glm::radians(17.5f));
+        lights.spotLight.ambient = spotLightColor * glm::vec3(0.2f);
+        lights.spotLight.diffuse = spotLightColor * glm::vec3(0.9f);
+        lights.spotLight.specular = glm::vec3(1.0f);
+
+        // Uploaded once, seen by every shader declaring LightConstants and FrameConstants blocks
+        FrameUniforms::setLights(lights);
+        FrameUniforms::setFrame(proj, view, camera->Position);
+
+        objectShader->setUniform1i(UNIFORM("reflectOn"), reflect);
+        objectShader->setUniform1i(UNIFORM("refractOn"), refract);
         // Render floor
         model = glm::translate(glm::mat4(1.0f), cubePositions[0]);
         model = glm::scale(model, glm::vec3(5.0f, 1.0f, 5.0f));
-        objectShader->setUniformMat4f("model", model);
+        objectShader->setUniformMat4f(UNIFORM("model"), model);
         renderer.draw(*floorVao, *floorIbo, *objectShader);
 
         // Render containers
         for (unsigned int i = 0; i < 3; i++) {
             model = glm::translate(glm::mat4(1.0f), cubePositions[i]);
-            objectShader->setUniformMat4f("model", model);
+            objectShader->setUniformMat4f(UNIFORM("model"), model);
             renderer.draw(*vao, *ibo, *objectShader);
         }
 
@@ -313,8 +309,8 @@ namespace test {
         model = glm::scale(model, glm::vec3(0.5f, 0.5f, 0.5f));
 
         glm::mat4 mvp = proj * view * model;
-        lightSourceShader->setUniformMat4f("u_MVP", mvp);
-        lightSourceShader->setUniform3f("lightColor", pointLightColor.x, pointLightColor.y, pointLightColor.z);
+        lightSourceShader->setUniformMat4f(UNIFORM("u_MVP"), mvp);
+        lightSourceShader->setUniform3f(UNIFORM("lightColor"), pointLightColor.x, pointLightColor.y, pointLightColor.z);
         renderer.draw(*vao, *ibo, *lightSourceShader);
 
         // Render skybox
@@ -323,9 +319,10 @@ namespace test {
         // and skybox fragments wont be drawn if depth is less than 1.0 meaning there are objects in front of the skybox
         glDepthFunc(GL_EQUAL);
         cubemapShader->bind();
-        cubemapShader->setUniformMat4f("projection", proj);
+        cubemapShader->setUniform1i(UNIFORM("cubemap"), 0);
+        cubemapShader->setUniformMat4f(UNIFORM("projection"), proj);
         glm::mat4 skyboxViewMat = glm::mat4(glm::mat3(view));
-        cubemapShader->setUniformMat4f("view", skyboxViewMat);
+        cubemapShader->setUniformMat4f(UNIFORM("view"), skyboxViewMat);
         cubemapTexture->bind();
         renderer.draw(*skyboxVao, *ibo, *cubemapShader);
         glDepthFunc(GL_LESS); // Back to default
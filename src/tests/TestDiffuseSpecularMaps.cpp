@@ -15,13 +15,8 @@
 namespace test {
 
     TestDiffuseSpecularMaps::TestDiffuseSpecularMaps() {
-        // TODO: pass screen coords in instead of creating these raw pointers here
-        // to get screen measurements
-        GLFWmonitor* monitor = glfwGetPrimaryMonitor();
-        const GLFWvidmode* mode = glfwGetVideoMode(monitor);
-
-        screenWidth = mode->width;
-        screenHeight = mode->height;
+        screenWidth = getScreenWidth();
+        screenHeight = getScreenHeight();
 
         // Enable depth testing
         glEnable(GL_DEPTH_TEST);
@@ -104,16 +99,14 @@ namespace test {
         ibo = std::make_unique<IndexBuffer>(indices, 36);
 
 
+        // Programs are linked in background, uniforms are set once they are ready (see onRender)
         lightingShader = std::make_unique<Shader>("assets/shaders/lightingMaps.glsl");
-        lightingShader->bind();
 
         diffuseMap = std::make_unique<Texture>("assets/textures/container.png");
         specularMap = std::make_unique<Texture>("assets/textures/container_specular.png");
 	// Bind both maps to different slots and set uniforms
         diffuseMap->bind();
 	specularMap->bind(1);
-        lightingShader->setUniform1i("material.diffuseMap", 0);
-        lightingShader->setUniform1i("material.specularMap", 1);
 
         lightSourceShader = std::make_unique<Shader>("assets/shaders/lightSourceVariableColor.glsl");
 
@@ -128,6 +121,9 @@ namespace test {
 
     void TestDiffuseSpecularMaps::onRender() {
         GLCall(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT));
+        // Binding would wait for the compiler
+        if (!lightingShader->isReady() || !lightSourceShader->isReady())
+            return;
 
         diffuseMap->bind(); // bound to default slot 0
 	specularMap->bind(1);
@@ -163,21 +159,23 @@ namespace test {
         glm::vec3 ambientColor = lightColor * glm::vec3(0.2f);
 
         lightingShader->bind();
+        lightingShader->setUniform1i(UNIFORM("material.diffuseMap"), 0);
+        lightingShader->setUniform1i(UNIFORM("material.specularMap"), 1);
         //lightingShader->setUniform3f("material.ambient", 1.0f, 0.5f, 0.31f);
         //lightingShader->setUniform3f("material.diffuse", 1.0f, 0.5f, 0.31f);
         //lightingShader->setUniform3f("material.specular", 0.5f, 0.5f, 0.5f);
-        lightingShader->setUniform1f("material.shininess", 32.0f);
+        lightingShader->setUniform1f(UNIFORM("material.shininess"), 32.0f);
 
-        lightingShader->setUniform3f("light.ambient", ambientColor.x, ambientColor.y, ambientColor.z);
-        lightingShader->setUniform3f("light.diffuse", diffuseColor.x, diffuseColor.y, diffuseColor.z);
-        lightingShader->setUniform3f("light.specular", 1.0f, 1.0f, 1.0f);
-        lightingShader->setUniform3f("light.position", lightPosition.x, lightPosition.y, lightPosition.z);
+        lightingShader->setUniform3f(UNIFORM("light.ambient"), ambientColor.x, ambientColor.y, ambientColor.z);
+        lightingShader->setUniform3f(UNIFORM("light.diffuse"), diffuseColor.x, diffuseColor.y, diffuseColor.z);
+        lightingShader->setUniform3f(UNIFORM("light.specular"), 1.0f, 1.0f, 1.0f);
+        lightingShader->setUniform3f(UNIFORM("light.position"), lightPosition.x, lightPosition.y, lightPosition.z);
 
-        lightingShader->setUniform3f("viewPosition", camera->Position.x, camera->Position.y, camera->Position.z);
+        lightingShader->setUniform3f(UNIFORM("viewPosition"), camera->Position.x, camera->Position.y, camera->Position.z);
 
-        lightingShader->setUniformMat4f("projection", proj);
-        lightingShader->setUniformMat4f("view", view);
-        lightingShader->setUniformMat4f("model", model);
+        lightingShader->setUniformMat4f(UNIFORM("projection"), proj);
+        lightingShader->setUniformMat4f(UNIFORM("view"), view);
+        lightingShader->setUniformMat4f(UNIFORM("model"), model);
 
         renderer.draw(*vao, *ibo, *lightingShader);
 
@@ -187,8 +185,8 @@ namespace test {
         model = glm::scale(model, glm::vec3(0.5f, 0.5f, 0.5f));
 
         glm::mat4 mvp = proj * view * model;
-        lightSourceShader->setUniformMat4f("u_MVP", mvp);
-        lightSourceShader->setUniform3f("lightColor", lightColor.x, lightColor.y, lightColor.z);
+        lightSourceShader->setUniformMat4f(UNIFORM("u_MVP"), mvp);
+        lightSourceShader->setUniform3f(UNIFORM("lightColor"), lightColor.x, lightColor.y, lightColor.z);
         renderer.draw(*vao, *ibo, *lightSourceShader);
     }
 
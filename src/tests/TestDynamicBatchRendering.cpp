@@ -9,7 +9,6 @@
 #include "imgui/imgui.h"
 
 #include <GLFW/glfw3.h>
-#include <array>
 
 namespace test {
 
@@ -35,6 +34,20 @@ namespace test {
         Vec4 color;
         float texID; // GL Texture slot
     };
+}
+
+// Test's own vector types need to be known to vertex format as well
+template <> struct AttributeTraits<test::Vec2> : AttributeTraitsOf<GL_FLOAT, float, 2> {};
+template <> struct AttributeTraits<test::Vec3> : AttributeTraitsOf<GL_FLOAT, float, 3> {};
+template <> struct AttributeTraits<test::Vec4> : AttributeTraitsOf<GL_FLOAT, float, 4> {};
+
+namespace test {
+
+    using BatchVertexFormat = VertexFormat<Vertex,
+          VERTEX_MEMBER(Vertex, position),
+          VERTEX_MEMBER(Vertex, texCoord),
+          VERTEX_MEMBER(Vertex, color),
+          VERTEX_MEMBER(Vertex, texID)>;
 
     static Vertex* createQuad(Vertex* target, float x, float y, float w, float h, float textureID) {
 
@@ -71,18 +84,11 @@ namespace test {
 
     TestDynamicBatchRendering::TestDynamicBatchRendering()
         : translation(0, 0, 0),
-        cameraTranslation(0, 0, -1.0f), cameraRotation(0, 0, 0) ,scale(0.2), rotation(45.0f), quad0x(0.1f), quad0y(0.1f) {
-
-        // TODO: pass screen coords in instead of creating these raw pointers here
-        // to get screen measurements
-        GLFWmonitor* monitor = glfwGetPrimaryMonitor();
-        const GLFWvidmode* mode = glfwGetVideoMode(monitor);
-
-        screenWidth = mode->width;
-        screenHeight = mode->height;
+        cameraTranslation(0, 0, -1.0f), cameraRotation(0, 0, 0) ,scale(0.2), rotation(45.0f), quad0x(0.1f), quad0y(0.1f),
+        persistentMapping(true), quadCount(0) {
 
-        //free(monitor);
-        //free(mode);
+        screenWidth = getScreenWidth();
+        screenHeight = getScreenHeight();
 
         // TODO: if this is uint32_t, the cast in IndexBuffer constructor to
         // const unsigned int pointer causes weird issues and big lag
@@ -103,39 +109,18 @@ namespace test {
             offset += 4;
         }
 
-        // Using vertex array means we dont need to specify vertex attributes every time we draw
-        // also let's us specify different vertex layouts, default vao can be used with compability profile
-        // core profile requires vao to be set
-        vao = std::make_unique<VertexArray>();
-        // If we want to change vertex data dynamically, we set data to nullptr and use GL_DYNAMIC_DRAW
-        vbo = std::make_unique<VertexBuffer>(nullptr, MaxVertexCount * sizeof(Vertex), GL_DYNAMIC_DRAW);
-
-        VertexBufferLayout layout;
-        layout.push<float>(3); // position
-        layout.push<float>(2); // texture coords
-        layout.push<float>(4); // vertex color
-        layout.push<float>(1); // texture slot id
-
-        vao->addBuffer(*vbo, layout);
+        createVertexStream();
 
         // Generate and bind index buffer object
         ibo = std::make_unique<IndexBuffer>(indices, MaxIndexCount);
 
+        // Program is linked in background, uniforms are set once it is ready (see onRender)
         shader = std::make_unique<Shader>("assets/shaders/batch.glsl");
-        shader->bind();
-        shader->setUniform4f("u_Color", 0.8f, 0.3f, 0.8f, 1.0f);
-
-        auto loc = glGetUniformLocation(shader->getRendererID(), "u_textures");
-        int samplers[2] = {0, 1};
-        glUniform1iv(loc, 2, samplers);
 
         texture = std::make_unique<Texture>("assets/textures/slime.png");
         texture2 = std::make_unique<Texture>("assets/textures/mountains.png");
         texture->bind(); // bound to default slot 0
-        // Set uniform to tell shader that we need to sample texture from slot 0
-        shader->setUniform1i("u_Texture", 0);
         texture2->bind(1);
-        shader->setUniform1i("u_Texture", 1);
 
         glDisable(GL_DEPTH_TEST);
     }
@@ -143,26 +128,40 @@ namespace test {
     TestDynamicBatchRendering::~TestDynamicBatchRendering() {
     }
 
+    void TestDynamicBatchRendering::createVertexStream() {
+        // Using vertex array means we dont need to specify vertex attributes every time we draw
+        // also let's us specify different vertex layouts, default vao can be used with compability profile
+        // core profile requires vao to be set
+        vao = std::make_unique<VertexArray>();
+        // Vertex data is rewritten every frame, so each frame gets its own region of stream buffer
+        vbo = std::make_unique<StreamBuffer>(GL_ARRAY_BUFFER, MaxVertexCount * sizeof(Vertex), persistentMapping);
+
+        // Position, texture coords, vertex color and texture slot id, attribute setup is generated at compile time
+        vao->addBuffer(*vbo, BatchVertexFormat::view());
+    }
+
     void TestDynamicBatchRendering::onUpdate(float deltaTime) {
-        std::array<Vertex, 1000> vertices;
-        Vertex* buffer = vertices.data();
         // Setting dynamic vertex buffer data
-        // Creating couple of quads and copying them into vertices guffer which
-        // then is passed to glBufferSubData
+        // Creating couple of quads straight in mapped stream buffer memory, no intermediate copy
+        Vertex* start = static_cast<Vertex*>(vbo->map());
+        Vertex* buffer = start;
         for (int y = 0; y < 5; y++) {
             for (int x = 0; x < 5; x++) {
                 buffer = createQuad(buffer, x, y, 0.8f, 0.5f, 1.0f);
             }
         }
         buffer = createQuad(buffer, quad0x, quad0y, 0.5f, 0.5f, 0.0f);
+        vbo->unmap();
 
-        vbo->bind();
-        GLCall(glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(Vertex) * vertices.size(), vertices.data()));
+        quadCount = (buffer - start) / 4;
     }
 
     void TestDynamicBatchRendering::onRender() {
         GLCall(glClearColor(0.0f, 0.0f, 0.0f, 1.0f));
         GLCall(glClear(GL_COLOR_BUFFER_BIT));
+        // Binding would wait for the compiler
+        if (!shader->isReady())
+            return;
 
         texture->bind(); // bound to default slot 0
         texture2->bind(1);
@@ -189,9 +188,14 @@ namespace test {
         Renderer renderer;
 
         shader->bind();
-        shader->setUniform4f("u_Color", 0.5f, 0.3f, 0.8f, 1.0f);
-        shader->setUniformMat4f("u_MVP", mvp);
-        renderer.draw(*vao, *ibo, *shader);
+        auto loc = glGetUniformLocation(shader->getRendererID(), "u_textures");
+        int samplers[2] = {0, 1};
+        glUniform1iv(loc, 2, samplers);
+        shader->setUniform4f(UNIFORM("u_Color"), 0.5f, 0.3f, 0.8f, 1.0f);
+        shader->setUniformMat4f(UNIFORM("u_MVP"), mvp);
+        // Attributes point at the start of the stream, base vertex selects region written this frame
+        renderer.drawBaseVertex(*vao, *ibo, *shader, quadCount * 6, vbo->getRegionOffset() / sizeof(Vertex));
+        vbo->lockRegion();
     }
 
     void TestDynamicBatchRendering::onImGuiRender() {
@@ -215,6 +219,12 @@ namespace test {
         ImGui::SliderFloat("X", &quad0x, -1.0f, 1.0f);
         ImGui::SliderFloat("Y", &quad0y, -1.0f, 1.0f);
 
+        ImGui::Separator();
+        if (ImGui::Checkbox("Persistent mapped stream buffer", &persistentMapping))
+            createVertexStream();
+        ImGui::Text("Stream buffer mode: %s, stalls: %u",
+                vbo->getMode() == StreamBufferMode::PERSISTENT ? "persistent (ARB_buffer_storage)" : "orphaning",
+                vbo->getStallCount());
     }
 }
 
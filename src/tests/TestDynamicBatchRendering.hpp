@@ -4,6 +4,7 @@
 #include "Test.hpp"
 #include "glm/glm.hpp"
 #include "../VertexBuffer.hpp"
+#include "../StreamBuffer.hpp"
 #include "../VertexBufferLayout.hpp"
 #include "../Texture.hpp"
 
@@ -31,7 +32,7 @@ namespace test {
             float quad0y;
 
             std::unique_ptr<VertexArray> vao;
-            std::unique_ptr<VertexBuffer> vbo;
+            std::unique_ptr<StreamBuffer> vbo;
             std::unique_ptr<IndexBuffer> ibo;
             std::unique_ptr<Shader> shader;
             std::unique_ptr<Texture> texture;
@@ -39,6 +40,11 @@ namespace test {
 
             glm::mat4 proj;
             int screenWidth, screenHeight;
+
+            bool persistentMapping;
+            unsigned int quadCount; ///< Quads written into current region of stream buffer
+
+            void createVertexStream();
     };
 }
 #endif // __TestDynamicBatchRendering__
@@ -1,6 +1,9 @@
 #include "TestFramebuffers.hpp"
 
 #include "../Renderer.hpp"
+#include "../FrameUniforms.hpp"
+#include "../GLState.hpp"
+#include "../GPUProfiler.hpp"
 
 #include "glm/gtc/matrix_transform.hpp"
 
@@ -16,13 +19,8 @@
 namespace test {
 
     TestFramebuffers::TestFramebuffers() {
-        // TODO: pass screen coords in instead of creating these raw pointers here
-        // to get screen measurements
-        GLFWmonitor* monitor = glfwGetPrimaryMonitor();
-        const GLFWvidmode* mode = glfwGetVideoMode(monitor);
-
-        screenWidth = mode->width;
-        screenHeight = mode->height;
+        screenWidth = getScreenWidth();
+        screenHeight = getScreenHeight();
         std::cout << "Screen Width: " << screenWidth << ", Screen Height: " << screenHeight << "\n";
 
         glEnable(GL_DEPTH_TEST);
@@ -126,16 +124,14 @@ namespace test {
         floorVao->addBuffer(*floorVbo, layout);
         floorIbo = std::make_unique<IndexBuffer>(floorIndices, 6);
 
+        // Programs are linked in background, uniforms are set once they are ready (see onRender)
         objectShader = std::make_unique<Shader>("assets/shaders/lightCasters.glsl");
-        objectShader->bind();
 
         diffuseMap = std::make_unique<Texture>("assets/textures/container.png");
         specularMap = std::make_unique<Texture>("assets/textures/container_specular.png");
 	// Bind both maps to different slots and set uniforms
         diffuseMap->bind();
 	specularMap->bind(1);
-        objectShader->setUniform1i("material.diffuseMap", 0);
-        objectShader->setUniform1i("material.specularMap", 1);
 
         lightSourceShader = std::make_unique<Shader>("assets/shaders/lightSourceVariableColor.glsl");
 
@@ -161,14 +157,13 @@ namespace test {
 
         // Create and configure texture for a framebuffer
         glGenTextures(1, &renderTextureID);
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, renderTextureID);
+        GLState::bindTexture(0, GL_TEXTURE_2D, renderTextureID);
         glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, screenWidth, screenHeight, 0, GL_RGB, GL_UNSIGNED_BYTE, NULL);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
         // Attach texture to the framebuffer
         glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, renderTextureID, 0);
-        glBindTexture(GL_TEXTURE_2D, 0);
+        GLState::bindTexture(0, GL_TEXTURE_2D, 0);
 
         // Create renderbuffer object
         glGenRenderbuffers(1, &rbo);
@@ -203,7 +198,9 @@ namespace test {
 
         screenQuadVao->addBuffer(*screenQuadVbo, layout2d);
         floorIbo->bind();
-        postProcessingShader = std::make_unique<Shader>("assets/shaders/texture2D.vert", "assets/shaders/postProcessing.frag");
+        postProcessingShaders = std::make_unique<ShaderPermutations>("assets/shaders/texture2D.vert",
+                "assets/shaders/postProcessing.frag",
+                std::vector<std::string>{"INVERT_COLORS", "GRAYSCALE", "SHARPEN", "BLUR", "EDGE_DETECTION"});
     }
 
     TestFramebuffers::~TestFramebuffers() {
@@ -215,8 +212,14 @@ namespace test {
     }
 
     void TestFramebuffers::onRender() {
+        // Binding would wait for the compiler
+        if (!objectShader->isReady() || !lightSourceShader->isReady()) {
+            GLCall(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT));
+            return;
+        }
 
         // Set up first pass to render the scene onto custom framebuffer
+        GPUProfiler::beginScope("scene pass");
         glBindFramebuffer(GL_FRAMEBUFFER, fbo);
         GLCall(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT));
         glEnable(GL_DEPTH_TEST);
@@ -243,45 +246,47 @@ namespace test {
         Renderer renderer;
 
         objectShader->bind();
-        objectShader->setUniform1f("material.shininess", 32.0f);
-
-        objectShader->setUniformVec3("dirLight.direction", lightDirection);
-        objectShader->setUniformVec3("dirLight.ambient", dirLightColor * glm::vec3(0.1f));
-        objectShader->setUniformVec3("dirLight.diffuse", dirLightColor * glm::vec3(0.5f));
-        objectShader->setUniform3f("dirLight.specular", 1.0f, 1.0f, 1.0f);
-
-        objectShader->setUniformVec3("pointLight.position", lightPosition);
-        objectShader->setUniformVec3("pointLight.ambient", pointLightColor * glm::vec3(0.1f));
-        objectShader->setUniformVec3("pointLight.diffuse", pointLightColor * glm::vec3(0.2f));
-        objectShader->setUniform3f("pointLight.specular", 1.0f, 1.0f, 1.0f);
-        objectShader->setUniform1f("pointLight.constant", constant);
-        objectShader->setUniform1f("pointLight.linear", linear);
-        objectShader->setUniform1f("pointLight.quadratic", quadratic);
+        objectShader->setUniform1i(UNIFORM("material.diffuseMap"), 0);
+        objectShader->setUniform1i(UNIFORM("material.specularMap"), 1);
+        objectShader->setUniform1f(UNIFORM("material.shininess"), 32.0f);
+
+        LightConstants lights = {};
+        lights.dirLight.direction = lightDirection;
+        lights.dirLight.ambient = dirLightColor * glm::vec3(0.1f);
+        lights.dirLight.diffuse = dirLightColor * glm::vec3(0.5f);
+        lights.dirLight.specular = glm::vec3(1.0f);
+
+        lights.pointLight.position = lightPosition;
+        lights.pointLight.ambient = pointLightColor * glm::vec3(0.1f);
+        lights.pointLight.diffuse = pointLightColor * glm::vec3(0.2f);
+        lights.pointLight.specular = glm::vec3(1.0f);
+        lights.pointLight.constant = constant;
+        lights.pointLight.linear = linear;
+        lights.pointLight.quadratic = quadratic;
 
         // Make spot light position same as camera thus simulating flashlight!
-        objectShader->setUniformVec3("spotLight.position", camera->Position);
-        objectShader->setUniformVec3("spotLight.direction", camera->Front);
-        objectShader->setUniform1f("spotLight.cutOff", glm::cos(glm::radians(12.5f)));
-        objectShader->setUniform1f("spotLight.outerCutOff", glm::cos(glm::radians(17.5f)));
-        objectShader->setUniformVec3("spotLight.ambient", spotLightColor * glm::vec3(0.2f));
-        objectShader->setUniformVec3("spotLight.diffuse", spotLightColor * glm::vec3(0.9f));
-        objectShader->setUniform3f("spotLight.specular", 1.0f, 1.0f, 1.0f);
-
-        objectShader->setUniformVec3("viewPosition", camera->Position);
-
-        objectShader->setUniformMat4f("projection", proj);
-        objectShader->setUniformMat4f("view", view);
+        lights.spotLight.position = camera->Position;
+        lights.spotLight.direction = camera->Front;
+        lights.spotLight.cutOff = glm::cos(glm::radians(12.5f));
+        lights.spotLight.outerCutOff = glm::cos(glm::radians(17.5f));
+        lights.spotLight.ambient = spotLightColor * glm::vec3(0.2f);
+        lights.spotLight.diffuse = spotLightColor * glm::vec3(0.9f);
+        lights.spotLight.specular = glm::vec3(1.0f);
+
+        // Uploaded once, seen by every shader declaring LightConstants and FrameConstants blocks
+        FrameUniforms::setLights(lights);
+        FrameUniforms::setFrame(proj, view, camera->Position);
 
         // Render floor
         model = glm::translate(glm::mat4(1.0f), cubePositions[0]);
         model = glm::scale(model, glm::vec3(5.0f, 1.0f, 5.0f));
-        objectShader->setUniformMat4f("model", model);
+        objectShader->setUniformMat4f(UNIFORM("model"), model);
         renderer.draw(*floorVao, *floorIbo, *objectShader);
 
         // Render containers
         for (unsigned int i = 0; i < 3; i++) {
             model = glm::translate(glm::mat4(1.0f), cubePositions[i]);
-            objectShader->setUniformMat4f("model", model);
+            objectShader->setUniformMat4f(UNIFORM("model"), model);
             renderer.draw(*vao, *ibo, *objectShader);
         }
 
@@ -291,27 +296,30 @@ namespace test {
         model = glm::scale(model, glm::vec3(0.5f, 0.5f, 0.5f));
 
         glm::mat4 mvp = proj * view * model;
-        lightSourceShader->setUniformMat4f("u_MVP", mvp);
-        lightSourceShader->setUniform3f("lightColor", pointLightColor.x, pointLightColor.y, pointLightColor.z);
+        lightSourceShader->setUniformMat4f(UNIFORM("u_MVP"), mvp);
+        lightSourceShader->setUniform3f(UNIFORM("lightColor"), pointLightColor.x, pointLightColor.y, pointLightColor.z);
         renderer.draw(*vao, *ibo, *lightSourceShader);
+        GPUProfiler::endScope();
 
 
         // Setup 2nd pass to render this time rendering to default framebuffer
         // using screen quad texture
+        GPUProfiler::beginScope("post-process");
         glBindFramebuffer(GL_FRAMEBUFFER, 0);
         glDisable(GL_DEPTH_TEST);
         glClear(GL_COLOR_BUFFER_BIT);
 
-        postProcessingShader->bind();
-        postProcessingShader->setUniform1i("texture1", 0);
-        postProcessingShader->setUniform1i("invertColors", invertColors);
-        postProcessingShader->setUniform1i("grayScale", grayScale);
-        postProcessingShader->setUniform1i("sharpen", sharpen);
-        postProcessingShader->setUniform1i("blur", blur);
-        postProcessingShader->setUniform1i("edgeDetection", edgeDetection);
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, renderTextureID);
-        renderer.draw(*screenQuadVao, *floorIbo, *postProcessingShader);
+        uint32_t effects = (invertColors ? 1u : 0u) | (grayScale ? 2u : 0u) | (sharpen ? 4u : 0u)
+            | (blur ? 8u : 0u) | (edgeDetection ? 16u : 0u);
+        Shader& postProcessingShader = postProcessingShaders->get(effects);
+        // Binding first permutation before it is linked would wait for the compiler
+        if (postProcessingShader.isReady()) {
+            postProcessingShader.bind();
+            postProcessingShader.setUniform1i(UNIFORM("texture1"), 0);
+            GLState::bindTexture(0, GL_TEXTURE_2D, renderTextureID);
+            renderer.draw(*screenQuadVao, *floorIbo, postProcessingShader);
+        }
+        GPUProfiler::endScope();
     }
 
     void TestFramebuffers::onImGuiRender() {
@@ -322,6 +330,9 @@ namespace test {
         ImGui::Checkbox("Sharpen", &sharpen);
         ImGui::Checkbox("Blur", &blur);
         ImGui::Checkbox("Edge Detection", &edgeDetection);
+        ImGui::Text("%u effect permutations compiled", postProcessingShaders->getPermutationCount());
+        // Permutations differ in fragment stage only, with separable programs they share one vertex stage
+        ImGui::Text("%u separable shader stages in use", Shader::getStageCount());
     }
 }
 
@@ -7,6 +7,7 @@
 #include "../Camera.hpp"
 #include "../VertexBufferLayout.hpp"
 #include "../Texture.hpp"
+#include "../ShaderPermutations.hpp"
 
 #include <memory>
 
@@ -43,9 +44,10 @@ namespace test {
             unsigned int rbo; // Renderbuffer object also used as an attachment, they can only be written to and are useful for writing or copying data between buffers
             std::unique_ptr<VertexArray> screenQuadVao;
             std::unique_ptr<VertexBuffer> screenQuadVbo;
-            std::unique_ptr<Shader> postProcessingShader;
+            // Every combination of enabled effects is compiled into its own program
+            std::unique_ptr<ShaderPermutations> postProcessingShaders;
 
-            // Post-Processing Effects flags
+            // Post-Processing Effects flags, bit order matches features of postProcessingShaders
             bool invertColors = false;
             bool grayScale = false;
             bool sharpen = false;
@@ -1,23 +1,23 @@
 #include "TestInstancing.hpp"
 
 #include "../Renderer.hpp"
+#include "../GPUProfiler.hpp"
 #include "glm/gtc/matrix_transform.hpp"
 #include <iostream>
 #include "imgui/imgui.h"
 #include <GLFW/glfw3.h>
+#include <chrono>
 
 namespace test {
 
     const float NUM_CUBES = pow(10, 3);
     const int NUM_ASTEROIDS = 20000;
 
-    TestInstancing::TestInstancing() {
+    TestInstancing::TestInstancing()
+        : tumblingAsteroids(500), renderTimes{0.0f, 0.0f, 0.0f}, callsPerFrame(0), benchmarkCalls(0) {
 
-        GLFWmonitor* monitor = glfwGetPrimaryMonitor();
-        const GLFWvidmode* mode = glfwGetVideoMode(monitor);
-
-        screenWidth = mode->width;
-        screenHeight = mode->height;
+        screenWidth = getScreenWidth();
+        screenHeight = getScreenHeight();
 
         // Enable depth testing
         glEnable(GL_DEPTH_TEST);
@@ -174,49 +174,46 @@ namespace test {
         // Generate and bind index buffer object
         ibo = std::make_unique<IndexBuffer>(indices, 36);
 
+        // Programs are linked in background, uniforms are set once they are ready (see onRender)
         shader = std::make_unique<Shader>("assets/shaders/instancing.glsl");
-        shader->bind();
 
         texture = std::make_unique<Texture>("assets/textures/dirt.png");
         texture->bind(); // bound to default slot 0
-        // Set uniform to tell shader that we need to sample texture from slot 0
-        shader->setUniform1i("u_texture", 0);
 
-        rockModel = std::make_unique<Model>("assets/models/rock.obj");
-        planetModel = std::make_unique<Model>("assets/models/planet.obj");
+        // Stored as strips, thousands of instances make index fetch noticeable
+        rockModel = std::make_unique<Model>("assets/models/rock.obj", true);
+        planetModel = std::make_unique<Model>("assets/models/planet.obj", true);
 
         instanceMatrixShader = std::make_unique<Shader>("assets/shaders/instanceMatrix.glsl"); // For asteroids
         mvpTextureShader = std::make_unique<Shader>("assets/shaders/cube_textured.glsl"); // For planet
 
-        asteroidInstanceVbo = std::make_unique<VertexBuffer>(&asteroidTransforms[0], NUM_ASTEROIDS * sizeof(glm::mat4));
+        asteroidInstanceVbo = std::make_unique<VertexBuffer>(&asteroidTransforms[0], NUM_ASTEROIDS * sizeof(glm::mat4), GL_DYNAMIC_DRAW);
 
-        for (unsigned int i = 0; i < rockModel->getMeshes()->size(); i++) {
-            (*rockModel->getMeshes())[i].getVao()->bind();
-            //asteroidInstanceVbo->bind();
-
-            std::size_t vec4Size = sizeof(glm::vec4);
-            // Vertex attributes pointers can only be up to vec4 in size, so we split
-            // mat4 into 4 vertex attribs
-            glEnableVertexAttribArray(2);
-            glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, 4 * vec4Size, (void*)0);
-            glEnableVertexAttribArray(3);
-            glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, 4 * vec4Size, (void*)(vec4Size));
-            glEnableVertexAttribArray(4);
-            glVertexAttribPointer(4, 4, GL_FLOAT, GL_FALSE, 4 * vec4Size, (void*)(2 * vec4Size));
-            glEnableVertexAttribArray(5);
-            glVertexAttribPointer(5, 4, GL_FLOAT, GL_FALSE, 4 * vec4Size, (void*)(3 * vec4Size));
-
-            glVertexAttribDivisor(2, 1);
-            glVertexAttribDivisor(3, 1);
-            glVertexAttribDivisor(4, 1);
-            glVertexAttribDivisor(5, 1);
-            (*rockModel->getMeshes())[i].getVao()->unbind();
+        // Instance matrix takes 4 locations (one per column), starting at location 2 they replace texture coords.
+        // Rock meshes only switch buffer of binding 0, so pool defragmentation needs no rebuild
+        rockVao = std::make_unique<VertexArray>();
+        rockVao->setFormat(MeshVertexFormat::view(), 0);
+        rockVao->setFormat(VertexFormat<glm::mat4, VertexMember<glm::mat4, 0>>::view(), 1, 2, 1);
+        rockVao->bindVertexBuffer(1, *asteroidInstanceVbo);
+    }
+
+    void TestInstancing::onUpdate(float deltaTime) {
+        // Each matrix is staged on its own, neighbouring ones end up in single upload
+        for (int i = 0; i < tumblingAsteroids; i++) {
+            asteroidTransforms[i] = glm::rotate(asteroidTransforms[i], deltaTime, glm::vec3(0.4f, 0.6f, 0.8f));
+            asteroidInstanceVbo->updateRange(i * sizeof(glm::mat4), sizeof(glm::mat4), &asteroidTransforms[i]);
         }
     }
 
     void TestInstancing::onRender() {
+        auto startTime = std::chrono::steady_clock::now();
+        unsigned long long callsBefore = GLDebug::getCallCount();
+
         GLCall(glClearColor(0.0f, 0.0f, 0.0f, 1.0f));
         GLCall(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT));
+        // Binding would wait for the compiler
+        if (!shader->isReady() || !instanceMatrixShader->isReady() || !mvpTextureShader->isReady())
+            return;
 
         texture->bind(); // bound to default slot 0
 
@@ -224,36 +221,84 @@ namespace test {
 
         Renderer renderer;
 
+        GPUProfiler::beginScope("cubes");
         shader->bind();
+        shader->setUniform1i(UNIFORM("u_texture"), 0);
         // MVP gets multiplied in reverse order here, because OpenGL stores matrices in column order
         // On Direct x this multiplication would be model * view * proj
-        shader->setUniformMat4f("u_MVP", proj * camera->getViewMatrix());
+        shader->setUniformMat4f(UNIFORM("u_MVP"), proj * camera->getViewMatrix());
         renderer.drawInstanced(*vao, *ibo, *shader, NUM_CUBES);
+        GPUProfiler::endScope();
 
+        GPUProfiler::beginScope("planet");
         glm::mat4 model = glm::mat4(1.0f);
         model = glm::translate(model, glm::vec3(0.0f, -3.0f, 0.0f));
         model = glm::scale(model, glm::vec3(4.0f));
         mvpTextureShader->bind();
-        mvpTextureShader->setUniform1i("u_texture", 0);
-        mvpTextureShader->setUniformMat4f("u_MVP", proj * camera->getViewMatrix());
+        mvpTextureShader->setUniform1i(UNIFORM("u_texture"), 0);
+        mvpTextureShader->setUniformMat4f(UNIFORM("u_MVP"), proj * camera->getViewMatrix());
         planetModel->draw(*mvpTextureShader);
+        GPUProfiler::endScope();
 
+        GPUProfiler::beginScope("asteroids");
         instanceMatrixShader->bind();
-        instanceMatrixShader->setUniformMat4f("u_MVP", proj * camera->getViewMatrix());
-        instanceMatrixShader->setUniform1i("u_texture", 0);
+        instanceMatrixShader->setUniformMat4f(UNIFORM("u_MVP"), proj * camera->getViewMatrix());
+        instanceMatrixShader->setUniform1i(UNIFORM("u_texture"), 0);
+        asteroidInstanceVbo->flush();
         for (unsigned int i = 0; i < rockModel->getMeshes()->size(); i++) {
-            (*rockModel->getMeshes())[i].getVao()->bind();
             // NOTE: Easily 60FPS with over 20k asteroids!
             // Starts lagging at around 50k
-            (*rockModel->getMeshes())[i].drawInstanced(*instanceMatrixShader, NUM_ASTEROIDS);
-            (*rockModel->getMeshes())[i].getVao()->unbind();
+            (*rockModel->getMeshes())[i].drawInstanced(*instanceMatrixShader, NUM_ASTEROIDS, rockVao.get());
         }
+        GPUProfiler::endScope();
+
+        // Same uniform upload repeated, cheap for the driver, so mostly GLCall wrapper cost is measured
+        glm::mat4 mvp = proj * camera->getViewMatrix();
+        int mvpLocation = instanceMatrixShader->getUniform<glm::mat4>(UNIFORM("u_MVP")).getLocation();
+        for (int i = 0; i < benchmarkCalls; i++) {
+            GLCall(glUniformMatrix4fv(mvpLocation, 1, GL_FALSE, &mvp[0][0]));
+        }
+
+        float frameTime = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+        float& average = renderTimes[static_cast<int>(GLDebug::getMode())];
+        average = (average == 0.0f) ? frameTime : average * 0.95f + frameTime * 0.05f;
+        callsPerFrame = GLDebug::getCallCount() - callsBefore;
     }
 
     void TestInstancing::onImGuiRender() {
         ImGui::SliderFloat("Camera pos X", &camera->Position.x, -1000.0f, 1000.0f);
         ImGui::SliderFloat("Camera pos Y", &camera->Position.y, -1000.0f, 1000.0f);
         ImGui::SliderFloat("Camera pos Z", &camera->Position.z, -1000.0f, 1000.0f);
+        ImGui::SliderInt("Tumbling asteroids", &tumblingAsteroids, 0, NUM_ASTEROIDS);
+
+        ImGui::Separator();
+        ImGui::Text("GLCall overhead benchmark");
+        ImGui::SliderInt("Extra GLCalls per frame", &benchmarkCalls, 0, 20000);
+#ifdef DEBUG
+        int mode = static_cast<int>(GLDebug::getMode());
+        ImGui::RadioButton("Bare calls", &mode, static_cast<int>(GLDebugMode::BARE));
+        ImGui::SameLine();
+        ImGui::RadioButton("glGetError", &mode, static_cast<int>(GLDebugMode::GET_ERROR));
+        if (GLDebug::hasDebugOutput()) {
+            ImGui::SameLine();
+            ImGui::RadioButton("KHR_debug", &mode, static_cast<int>(GLDebugMode::DEBUG_OUTPUT));
+        }
+        GLDebug::setMode(static_cast<GLDebugMode>(mode));
+        ImGui::Text("GLCalls in onRender: %llu", callsPerFrame);
+#else
+        ImGui::Text("Release build, GLCall compiles down to bare call");
+#endif
+        const char* modeNames[] = {"Bare calls", "glGetError", "KHR_debug"};
+        for (int i = 0; i < 3; i++) {
+            if (renderTimes[i] == 0.0f)
+                continue;
+            ImGui::Text("%-10s onRender CPU: %.3f ms", modeNames[i], renderTimes[i]);
+            // Difference against bare calls divided by number of wrapped calls is the cost of one check
+            if (i > 0 && renderTimes[0] > 0.0f && callsPerFrame > 0) {
+                ImGui::SameLine();
+                ImGui::Text("(%.1f ns per call)", (renderTimes[i] - renderTimes[0]) * 1000000.0f / callsPerFrame);
+            }
+        }
     }
 }
 
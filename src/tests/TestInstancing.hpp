@@ -18,7 +18,7 @@ namespace test {
             TestInstancing();
             ~TestInstancing() {}
 
-            void onUpdate(float deltaTime) override {}
+            void onUpdate(float deltaTime) override;
             void onRender() override;
             void onImGuiRender() override;
         private:
@@ -35,14 +35,22 @@ namespace test {
 
             std::unique_ptr<Model> rockModel;
             std::unique_ptr<Model> planetModel;
+            // Mesh format on binding 0, switched to each rock mesh's pool buffer, instance matrices on binding 1
+            std::unique_ptr<VertexArray> rockVao;
             std::unique_ptr<Shader> mvpTextureShader;
             std::unique_ptr<Shader> instanceMatrixShader;
 
             glm::vec3 cubePositions[1000];
             glm::mat4* asteroidTransforms;
+            int tumblingAsteroids; ///< First asteroids spin every frame, only their matrices get uploaded
 
             glm::mat4 proj;
             int screenWidth, screenHeight;
+
+            // GLCall overhead benchmark, CPU time of onRender averaged per GLDebugMode
+            float renderTimes[3];
+            unsigned long long callsPerFrame;
+            int benchmarkCalls; ///< Extra cheap GLCalls issued per frame to make per call cost visible
     };
 }
 #endif // __TestInstancing__
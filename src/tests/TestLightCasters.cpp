@@ -1,6 +1,7 @@
 #include "TestLightCasters.hpp"
 
 #include "../Renderer.hpp"
+#include "../FrameUniforms.hpp"
 
 #include "glm/gtc/matrix_transform.hpp"
 
@@ -15,13 +16,8 @@
 namespace test {
 
     TestLightCasters::TestLightCasters() {
-        // TODO: pass screen coords in instead of creating these raw pointers here
-        // to get screen measurements
-        GLFWmonitor* monitor = glfwGetPrimaryMonitor();
-        const GLFWvidmode* mode = glfwGetVideoMode(monitor);
-
-        screenWidth = mode->width;
-        screenHeight = mode->height;
+        screenWidth = getScreenWidth();
+        screenHeight = getScreenHeight();
 
         // Enable depth testing
         glEnable(GL_DEPTH_TEST);
@@ -104,16 +100,14 @@ namespace test {
         ibo = std::make_unique<IndexBuffer>(indices, 36);
 
 
+        // Programs are linked in background, uniforms are set once they are ready (see onRender)
         lightingShader = std::make_unique<Shader>("assets/shaders/lightCasters.glsl");
-        lightingShader->bind();
 
         diffuseMap = std::make_unique<Texture>("assets/textures/container.png");
         specularMap = std::make_unique<Texture>("assets/textures/container_specular.png");
 	// Bind both maps to different slots and set uniforms
         diffuseMap->bind();
 	specularMap->bind(1);
-        lightingShader->setUniform1i("material.diffuseMap", 0);
-        lightingShader->setUniform1i("material.specularMap", 1);
 
         lightSourceShader = std::make_unique<Shader>("assets/shaders/lightSourceVariableColor.glsl");
 
@@ -145,6 +139,9 @@ namespace test {
 
     void TestLightCasters::onRender() {
         GLCall(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT));
+        // Binding would wait for the compiler
+        if (!lightingShader->isReady() || !lightSourceShader->isReady())
+            return;
 
         diffuseMap->bind(); // bound to default slot 0
 	specularMap->bind(1);
@@ -175,37 +172,36 @@ namespace test {
         Renderer renderer;
 
         lightingShader->bind();
-        lightingShader->setUniform1f("material.shininess", 32.0f);
-
-        lightingShader->setUniformVec3("dirLight.direction", lightDirection);
-        lightingShader->setUniformVec3("dirLight.ambient", dirLightColor * glm::vec3(0.1f));
-        lightingShader->setUniformVec3("dirLight.diffuse", dirLightColor * glm::vec3(0.5f));
-        lightingShader->setUniform3f("dirLight.specular", 1.0f, 1.0f, 1.0f);
-
-        lightingShader->setUniformVec3("pointLight.position", lightPosition);
-        lightingShader->setUniformVec3("pointLight.ambient", pointLightColor * glm::vec3(0.1f));
-        lightingShader->setUniformVec3("pointLight.diffuse", pointLightColor * glm::vec3(0.2f));
-        lightingShader->setUniform3f("pointLight.specular", 1.0f, 1.0f, 1.0f);
-        lightingShader->setUniform1f("pointLight.constant", constant);
-        lightingShader->setUniform1f("pointLight.linear", linear);
-        lightingShader->setUniform1f("pointLight.quadratic", quadratic);
-        // If array of point lights declared, can set each uniform like this:
-        //lightingShader->setUniformVec3("pointLight[0].position", lightPosition);
+        lightingShader->setUniform1i(UNIFORM("material.diffuseMap"), 0);
+        lightingShader->setUniform1i(UNIFORM("material.specularMap"), 1);
+        lightingShader->setUniform1f(UNIFORM("material.shininess"), 32.0f);
+
+        LightConstants lights = {};
+        lights.dirLight.direction = lightDirection;
+        lights.dirLight.ambient = dirLightColor * glm::vec3(0.1f);
+        lights.dirLight.diffuse = dirLightColor * glm::vec3(0.5f);
+        lights.dirLight.specular = glm::vec3(1.0f);
+
+        lights.pointLight.position = lightPosition;
+        lights.pointLight.ambient = pointLightColor * glm::vec3(0.1f);
+        lights.pointLight.diffuse = pointLightColor * glm::vec3(0.2f);
+        lights.pointLight.specular = glm::vec3(1.0f);
+        lights.pointLight.constant = constant;
+        lights.pointLight.linear = linear;
+        lights.pointLight.quadratic = quadratic;
 
         // Make spot light position same as camera thus simulating flashlight!
-        lightingShader->setUniformVec3("spotLight.position", camera->Position);
-        lightingShader->setUniformVec3("spotLight.direction", camera->Front);
-        lightingShader->setUniform1f("spotLight.cutOff", glm::cos(glm::radians(12.5f)));
-        lightingShader->setUniform1f("spotLight.outerCutOff", glm::cos(glm::radians(17.5f)));
-        lightingShader->setUniformVec3("spotLight.ambient", spotLightColor * glm::vec3(0.2f));
-        lightingShader->setUniformVec3("spotLight.diffuse", spotLightColor * glm::vec3(0.9f));
-        lightingShader->setUniform3f("spotLight.specular", 1.0f, 1.0f, 1.0f);
-
-
-        lightingShader->setUniformVec3("viewPosition", camera->Position);
-
-        lightingShader->setUniformMat4f("projection", proj);
-        lightingShader->setUniformMat4f("view", view);
+        lights.spotLight.position = camera->Position;
+        lights.spotLight.direction = camera->Front;
+        lights.spotLight.cutOff = glm::cos(glm::radians(12.5f));
+        lights.spotLight.outerCutOff = glm::cos(glm::radians(17.5f));
+        lights.spotLight.ambient = spotLightColor * glm::vec3(0.2f);
+        lights.spotLight.diffuse = spotLightColor * glm::vec3(0.9f);
+        lights.spotLight.specular = glm::vec3(1.0f);
+
+        // Uploaded once, seen by every shader declaring LightConstants and FrameConstants blocks
+        FrameUniforms::setLights(lights);
+        FrameUniforms::setFrame(proj, view, camera->Position);
 
         // Render each object seperately using model matrix which is easy, but batch rendering is faster
         // need to learn instancing as well
@@ -217,7 +213,7 @@ namespace test {
             // for lighting called - normal matrix
             model = glm::scale(model, glm::vec3(2.0f, 2.0f, 2.0f));
 
-            lightingShader->setUniformMat4f("model", model);
+            lightingShader->setUniformMat4f(UNIFORM("model"), model);
 
             renderer.draw(*vao, *ibo, *lightingShader);
         }
@@ -229,8 +225,8 @@ namespace test {
         model = glm::scale(model, glm::vec3(0.5f, 0.5f, 0.5f));
 
         glm::mat4 mvp = proj * view * model;
-        lightSourceShader->setUniformMat4f("u_MVP", mvp);
-        lightSourceShader->setUniform3f("lightColor", pointLightColor.x, pointLightColor.y, pointLightColor.z);
+        lightSourceShader->setUniformMat4f(UNIFORM("u_MVP"), mvp);
+        lightSourceShader->setUniform3f(UNIFORM("lightColor"), pointLightColor.x, pointLightColor.y, pointLightColor.z);
         renderer.draw(*vao, *ibo, *lightSourceShader);
     }
 
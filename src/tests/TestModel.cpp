@@ -15,13 +15,8 @@
 namespace test {
 
     TestModel::TestModel() {
-        // TODO: pass screen coords in instead of creating these raw pointers here
-        // to get screen measurements
-        GLFWmonitor* monitor = glfwGetPrimaryMonitor();
-        const GLFWvidmode* mode = glfwGetVideoMode(monitor);
-
-        screenWidth = mode->width;
-        screenHeight = mode->height;
+        screenWidth = getScreenWidth();
+        screenHeight = getScreenHeight();
 
         // Enable depth testing
         glEnable(GL_DEPTH_TEST);
@@ -103,8 +98,10 @@ namespace test {
         // Generate and bind index buffer object
         ibo = std::make_unique<IndexBuffer>(indices, 36);
 
+        // Programs are linked in background, uniforms are set once they are ready (see onRender)
         lightingShader = std::make_unique<Shader>("assets/shaders/models.glsl");
-        lightingShader->bind();
+        indirectShader = std::make_unique<Shader>("assets/shaders/modelsIndirect.glsl");
+        useIndirect = true;
 
         //diffuseMap = std::make_unique<Texture>("assets/textures/container.png");
         //specularMap = std::make_unique<Texture>("assets/textures/container_specular.png");
@@ -143,6 +140,9 @@ namespace test {
 
     void TestModel::onRender() {
         GLCall(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT));
+        // Binding would wait for the compiler
+        if (!lightingShader->isReady() || !indirectShader->isReady() || !lightSourceShader->isReady())
+            return;
 
         //diffuseMap->bind(); // bound to default slot 0
 	//specularMap->bind(1);
@@ -159,43 +159,48 @@ namespace test {
 
         Renderer renderer;
 
-        lightingShader->bind();
-        lightingShader->setUniform1f("material.shininess", 32.0f);
-
-        lightingShader->setUniformVec3("dirLight.direction", lightDirection);
-        lightingShader->setUniformVec3("dirLight.ambient", dirLightColor * glm::vec3(0.2f));
-        lightingShader->setUniformVec3("dirLight.diffuse", dirLightColor * glm::vec3(0.5f));
-        lightingShader->setUniform3f("dirLight.specular", 1.0f, 1.0f, 1.0f);
-
-        lightingShader->setUniformVec3("pointLight.position", lightPosition);
-        lightingShader->setUniformVec3("pointLight.ambient", pointLightColor * glm::vec3(0.5f));
-        lightingShader->setUniformVec3("pointLight.diffuse", pointLightColor * glm::vec3(0.2f));
-        lightingShader->setUniform3f("pointLight.specular", 1.0f, 1.0f, 1.0f);
-        lightingShader->setUniform1f("pointLight.constant", constant);
-        lightingShader->setUniform1f("pointLight.linear", linear);
-        lightingShader->setUniform1f("pointLight.quadratic", quadratic);
+        // Both shaders share lighting uniforms, indirect one reads mesh color from per draw data
+        Shader* shader = useIndirect ? indirectShader.get() : lightingShader.get();
+        shader->bind();
+        shader->setUniform1f(UNIFORM("material.shininess"), 32.0f);
+
+        shader->setUniformVec3(UNIFORM("dirLight.direction"), lightDirection);
+        shader->setUniformVec3(UNIFORM("dirLight.ambient"), dirLightColor * glm::vec3(0.2f));
+        shader->setUniformVec3(UNIFORM("dirLight.diffuse"), dirLightColor * glm::vec3(0.5f));
+        shader->setUniform3f(UNIFORM("dirLight.specular"), 1.0f, 1.0f, 1.0f);
+
+        shader->setUniformVec3(UNIFORM("pointLight.position"), lightPosition);
+        shader->setUniformVec3(UNIFORM("pointLight.ambient"), pointLightColor * glm::vec3(0.5f));
+        shader->setUniformVec3(UNIFORM("pointLight.diffuse"), pointLightColor * glm::vec3(0.2f));
+        shader->setUniform3f(UNIFORM("pointLight.specular"), 1.0f, 1.0f, 1.0f);
+        shader->setUniform1f(UNIFORM("pointLight.constant"), constant);
+        shader->setUniform1f(UNIFORM("pointLight.linear"), linear);
+        shader->setUniform1f(UNIFORM("pointLight.quadratic"), quadratic);
         // If array of point lights declared, can set each uniform like this:
         //lightingShader->setUniformVec3("pointLight[0].position", lightPosition);
 
         // Make spot light position same as camera thus simulating flashlight!
-        lightingShader->setUniformVec3("spotLight.position", camera->Position);
-        lightingShader->setUniformVec3("spotLight.direction", camera->Front);
-        lightingShader->setUniform1f("spotLight.cutOff", glm::cos(glm::radians(12.5f)));
-        lightingShader->setUniform1f("spotLight.outerCutOff", glm::cos(glm::radians(17.5f)));
-        lightingShader->setUniformVec3("spotLight.ambient", spotLightColor * glm::vec3(0.2f));
-        lightingShader->setUniformVec3("spotLight.diffuse", spotLightColor * glm::vec3(0.9f));
-        lightingShader->setUniform3f("spotLight.specular", 1.0f, 1.0f, 1.0f);
+        shader->setUniformVec3(UNIFORM("spotLight.position"), camera->Position);
+        shader->setUniformVec3(UNIFORM("spotLight.direction"), camera->Front);
+        shader->setUniform1f(UNIFORM("spotLight.cutOff"), glm::cos(glm::radians(12.5f)));
+        shader->setUniform1f(UNIFORM("spotLight.outerCutOff"), glm::cos(glm::radians(17.5f)));
+        shader->setUniformVec3(UNIFORM("spotLight.ambient"), spotLightColor * glm::vec3(0.2f));
+        shader->setUniformVec3(UNIFORM("spotLight.diffuse"), spotLightColor * glm::vec3(0.9f));
+        shader->setUniform3f(UNIFORM("spotLight.specular"), 1.0f, 1.0f, 1.0f);
 
 
-        //lightingShader->setUniform3f("viewPosition", camera->Position.x, camera->Position.y, camera->Position.z);
-        lightingShader->setUniformVec3("viewPosition", camera->Position);
+        //shader->setUniform3f("viewPosition", camera->Position.x, camera->Position.y, camera->Position.z);
+        shader->setUniformVec3(UNIFORM("viewPosition"), camera->Position);
 
-        lightingShader->setUniformMat4f("projection", proj);
-        lightingShader->setUniformMat4f("view", view);
+        shader->setUniformMat4f(UNIFORM("projection"), proj);
+        shader->setUniformMat4f(UNIFORM("view"), view);
 
         model = glm::scale(glm::mat4(1.0), glm::vec3(10.0f, 10.0f, 10.0f));
-        lightingShader->setUniformMat4f("model", model);
-        model3d->draw(*lightingShader);
+        shader->setUniformMat4f(UNIFORM("model"), model);
+        if (useIndirect)
+            model3d->drawIndirect(*shader);
+        else
+            model3d->draw(*shader);
 
         //Model backpack("assets/models/backpack/backpack.obj");
         //backpack.draw(*lightingShader);
@@ -206,8 +211,8 @@ namespace test {
         model = glm::scale(model, glm::vec3(0.5f, 0.5f, 0.5f));
 
         glm::mat4 mvp = proj * view * model;
-        lightSourceShader->setUniformMat4f("u_MVP", mvp);
-        lightSourceShader->setUniform3f("lightColor", pointLightColor.x, pointLightColor.y, pointLightColor.z);
+        lightSourceShader->setUniformMat4f(UNIFORM("u_MVP"), mvp);
+        lightSourceShader->setUniform3f(UNIFORM("lightColor"), pointLightColor.x, pointLightColor.y, pointLightColor.z);
         renderer.draw(*vao, *ibo, *lightSourceShader);
     }
 
@@ -229,6 +234,10 @@ namespace test {
         ImGui::Text("X: %f, Y: %f. Z: %f", camera->Position.x, camera->Position.y, camera->Position.z);
         ImGui::Text("Camera Y: %f", camera->Position.y);
         ImGui::Text("Camera Z: %f", camera->Position.z);
+        ImGui::Separator();
+        ImGui::Checkbox("Multi draw indirect", &useIndirect);
+        unsigned int meshCount = model3d->getMeshes()->size();
+        ImGui::Text("Model draw calls: %u (%u meshes)", useIndirect ? model3d->getIndirectDrawCallCount() : meshCount, meshCount);
     }
 }
 
@@ -25,6 +25,7 @@ namespace test {
             std::unique_ptr<VertexBuffer> vbo;
             std::unique_ptr<IndexBuffer> ibo;
             std::unique_ptr<Shader> lightingShader;
+            std::unique_ptr<Shader> indirectShader; ///< Used with Model::drawIndirect
             std::unique_ptr<Shader> lightSourceShader;
             std::unique_ptr<Texture> diffuseMap;
             std::unique_ptr<Texture> specularMap;
@@ -44,6 +45,8 @@ namespace test {
             glm::vec3 spotLightColor;
 
             float constant, linear, quadratic;
+
+            bool useIndirect;
     };
 }
 #endif // __TestModel__
@@ -0,0 +1,172 @@
+#include "TestPackedVertices.hpp"
+
+#include "../Renderer.hpp"
+#include "../GPUProfiler.hpp"
+#include "glm/gtc/matrix_transform.hpp"
+#include "imgui/imgui.h"
+
+#include <algorithm>
+
+namespace test {
+
+    // Dense enough that vertex fetch, not rasterisation, dominates when drawn many times
+    const unsigned int SPHERE_SEGMENTS = 512;
+    const unsigned int SPHERE_RINGS = 256;
+    const int GRID_COLUMNS = 8;
+    const float GRID_SPACING = 2.5f;
+
+    TestPackedVertices::TestPackedVertices()
+        : maxPositionError(0.0f), maxNormalError(0.0f), maxTexCoordError(0.0f), instanceCount(16),
+        drawFloat(true), drawPacked(true), drawSplit(true), depthOnly(false) {
+        screenWidth = getScreenWidth();
+        screenHeight = getScreenHeight();
+
+        glEnable(GL_DEPTH_TEST);
+
+        std::vector<Vertex> vertices;
+        for (unsigned int ring = 0; ring <= SPHERE_RINGS; ring++) {
+            float v = (float)ring / SPHERE_RINGS;
+            float theta = v * glm::pi<float>();
+            for (unsigned int segment = 0; segment <= SPHERE_SEGMENTS; segment++) {
+                float u = (float)segment / SPHERE_SEGMENTS;
+                float phi = u * 2.0f * glm::pi<float>();
+                Vertex vertex;
+                vertex.Normal = glm::vec3(sin(theta) * cos(phi), cos(theta), sin(theta) * sin(phi));
+                vertex.Position = vertex.Normal;
+                vertex.TexCoords = glm::vec2(u, v);
+                vertices.push_back(vertex);
+            }
+        }
+        std::vector<unsigned int> indices;
+        for (unsigned int ring = 0; ring < SPHERE_RINGS; ring++) {
+            for (unsigned int segment = 0; segment < SPHERE_SEGMENTS; segment++) {
+                unsigned int current = ring * (SPHERE_SEGMENTS + 1) + segment;
+                unsigned int below = current + SPHERE_SEGMENTS + 1;
+                indices.insert(indices.end(), {current, current + 1, below, below, current + 1, below + 1});
+            }
+        }
+        vertexCount = vertices.size();
+
+        // Same encoding a model importer would do
+        quantization = VertexPacking::computeQuantization(vertices);
+        std::vector<PackedVertex> packed = VertexPacking::pack(vertices, quantization);
+        for (unsigned int i = 0; i < vertexCount; i++) {
+            Vertex unpacked = VertexPacking::unpack(packed[i], quantization);
+            maxPositionError = std::max(maxPositionError, glm::length(unpacked.Position - vertices[i].Position));
+            float cosine = glm::clamp(glm::dot(glm::normalize(unpacked.Normal), vertices[i].Normal), -1.0f, 1.0f);
+            maxNormalError = std::max(maxNormalError, glm::degrees(glm::acos(cosine)));
+            maxTexCoordError = std::max(maxTexCoordError, glm::length(unpacked.TexCoords - vertices[i].TexCoords));
+        }
+
+        std::vector<VertexPosition> positions(vertexCount);
+        std::vector<VertexAttributes> attributes(vertexCount);
+        for (unsigned int i = 0; i < vertexCount; i++) {
+            positions[i].Position = vertices[i].Position;
+            attributes[i] = {vertices[i].Normal, vertices[i].TexCoords};
+        }
+
+        floatVbo = std::make_unique<VertexBuffer>(vertices.data(), vertexCount * sizeof(Vertex));
+        packedVbo = std::make_unique<VertexBuffer>(packed.data(), vertexCount * sizeof(PackedVertex));
+        positionVbo = std::make_unique<VertexBuffer>(positions.data(), vertexCount * sizeof(VertexPosition));
+        attributeVbo = std::make_unique<VertexBuffer>(attributes.data(), vertexCount * sizeof(VertexAttributes));
+        ibo = std::make_unique<IndexBuffer>(indices.data(), indices.size());
+
+        shader = std::make_unique<Shader>("assets/shaders/packedVertices.glsl");
+        depthShader = std::make_unique<Shader>("assets/shaders/depthOnly.glsl");
+    }
+
+    void TestPackedVertices::draw(VertexArray& va, unsigned int layout, const glm::mat4& dequantization,
+            const glm::vec4& texCoordTransform) {
+        // Grids of the three layouts side by side, centered on origin
+        float gridWidth = GRID_COLUMNS * GRID_SPACING;
+        glm::vec3 offset((layout - 1.0f) * (gridWidth + GRID_SPACING) - 0.5f * gridWidth, 0.0f, 0.0f);
+        Shader& current = depthOnly ? *depthShader : *shader;
+        glm::mat4 model = glm::translate(glm::mat4(1.0f), offset);
+        current.setUniformMat4f(UNIFORM("u_model"), model * dequantization);
+        if (!depthOnly) {
+            current.setUniformMat3f(UNIFORM("u_normalMatrix"), glm::transpose(glm::inverse(glm::mat3(model))));
+            current.setUniformVec4(UNIFORM("u_texCoordTransform"), texCoordTransform);
+        }
+        Renderer renderer;
+        renderer.drawInstanced(va, *ibo, current, instanceCount);
+    }
+
+    void TestPackedVertices::onRender() {
+        GLCall(glClearColor(0.1f, 0.1f, 0.1f, 1.0f));
+        GLCall(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT));
+        // Binding or setting uniforms would wait for compiler, so nothing is drawn until both programs are linked
+        if (!shader->isReady() || !depthShader->isReady())
+            return;
+
+        proj = glm::perspective(glm::radians(camera->Zoom), (float)screenWidth/(float)screenHeight, 0.1f, 1000.0f);
+
+        Shader& current = depthOnly ? *depthShader : *shader;
+        current.bind();
+        current.setUniformMat4f(UNIFORM("u_viewProjection"), proj * camera->getViewMatrix());
+        current.setUniform1i(UNIFORM("u_columns"), GRID_COLUMNS);
+        current.setUniform1f(UNIFORM("u_spacing"), GRID_SPACING);
+        if (depthOnly) {
+            GLCall(glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE));
+        } else {
+            current.setUniformVec3(UNIFORM("u_lightDirection"), glm::normalize(glm::vec3(-0.2f, -1.0f, -0.3f)));
+        }
+
+        const glm::vec4 noTexCoordTransform(0.0f, 0.0f, 1.0f, 1.0f);
+        if (drawFloat) {
+            GPUProfiler::beginScope("float vertices");
+            VertexArray& va = Renderer::getVertexArray(MeshVertexFormat::view());
+            va.bindVertexBuffer(0, *floatVbo);
+            draw(va, 0, glm::mat4(1.0f), noTexCoordTransform);
+            GPUProfiler::endScope();
+        }
+        if (drawPacked) {
+            GPUProfiler::beginScope("packed vertices");
+            VertexArray& va = Renderer::getVertexArray(PackedVertexFormat::view());
+            va.bindVertexBuffer(0, *packedVbo);
+            draw(va, 1, quantization.getPositionTransform(), quantization.getTexCoordTransform());
+            GPUProfiler::endScope();
+        }
+        if (drawSplit) {
+            GPUProfiler::beginScope("split streams");
+            // Depth only pass leaves attribute stream out of the VAO entirely
+            VertexArray& va = depthOnly ? Renderer::getVertexArray(PositionStreamFormat::view())
+                : Renderer::getVertexArray({PositionStreamFormat::view(), AttributeStreamFormat::view()});
+            va.bindVertexBuffer(0, *positionVbo);
+            if (!depthOnly)
+                va.bindVertexBuffer(1, *attributeVbo);
+            draw(va, 2, glm::mat4(1.0f), noTexCoordTransform);
+            GPUProfiler::endScope();
+        }
+
+        if (depthOnly) {
+            GLCall(glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE));
+        }
+    }
+
+    void TestPackedVertices::onImGuiRender() {
+        ImGui::SliderInt("Instances", &instanceCount, 1, 256);
+        ImGui::Checkbox("Float", &drawFloat);
+        ImGui::SameLine();
+        ImGui::Checkbox("Packed", &drawPacked);
+        ImGui::SameLine();
+        ImGui::Checkbox("Split streams", &drawSplit);
+        ImGui::Checkbox("Depth only", &depthOnly);
+
+        if (!shader->isReady() || !depthShader->isReady())
+            ImGui::Text("Compiling shaders...");
+        ImGui::Text("%u vertices, %u indices", vertexCount, ibo->getCount());
+        // Upper bound, post transform cache skips refetching shared vertices
+        const float MB = 1024.0f * 1024.0f;
+        ImGui::Text("Float:  %u bytes per vertex, %.1f MB buffer, %.1f MB fetched per frame", MeshVertexFormat::STRIDE,
+                vertexCount * MeshVertexFormat::STRIDE / MB, vertexCount * MeshVertexFormat::STRIDE * instanceCount / MB);
+        ImGui::Text("Packed: %u bytes per vertex, %.1f MB buffer, %.1f MB fetched per frame", PackedVertexFormat::STRIDE,
+                vertexCount * PackedVertexFormat::STRIDE / MB, vertexCount * PackedVertexFormat::STRIDE * instanceCount / MB);
+        unsigned int splitStride = depthOnly ? PositionStreamFormat::STRIDE
+            : PositionStreamFormat::STRIDE + AttributeStreamFormat::STRIDE;
+        ImGui::Text("Split:  %u bytes per vertex fetched, %.1f MB fetched per frame", splitStride,
+                vertexCount * splitStride * instanceCount / MB);
+        ImGui::Text("Max error: position %.6f, normal %.3f deg, texture coords %.6f", maxPositionError, maxNormalError,
+                maxTexCoordError);
+        ImGui::Text("GPU times of each layout are in GPU profiler window");
+    }
+}
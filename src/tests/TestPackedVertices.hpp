@@ -0,0 +1,53 @@
+#ifndef __TestPackedVertices__
+#define __TestPackedVertices__
+
+#include "Test.hpp"
+#include "glm/glm.hpp"
+#include "../VertexArray.hpp"
+#include "../IndexBuffer.hpp"
+#include "../Shader.hpp"
+#include "../VertexPacking.hpp"
+
+#include <memory>
+
+namespace test {
+
+    // Vertex fetch bandwidth benchmark: same dense sphere stored as 32 byte float vertices, 16 byte packed
+    // vertices and float vertices split into position (12 bytes) and attribute streams, drawn many times side by side.
+    // In depth only mode shader reads positions only and split streams bind just the position stream.
+    // GPU time of each layout shows up in GPU profiler as "float vertices", "packed vertices" and "split streams",
+    // can be run headless with --bench "Vertex formats and streams"
+    class TestPackedVertices : public Test {
+        public:
+            TestPackedVertices();
+            ~TestPackedVertices() {}
+
+            void onRender() override;
+            void onImGuiRender() override;
+        private:
+            std::unique_ptr<VertexBuffer> floatVbo;
+            std::unique_ptr<VertexBuffer> packedVbo;
+            std::unique_ptr<VertexBuffer> positionVbo;
+            std::unique_ptr<VertexBuffer> attributeVbo;
+            std::unique_ptr<IndexBuffer> ibo;
+            std::unique_ptr<Shader> shader;
+            std::unique_ptr<Shader> depthShader;
+
+            VertexQuantization quantization;
+            unsigned int vertexCount;
+            float maxPositionError;
+            float maxNormalError; ///< Degrees
+            float maxTexCoordError;
+
+            int instanceCount;
+            bool drawFloat, drawPacked, drawSplit;
+            bool depthOnly; ///< Depth prepass like draws with color writes off
+
+            glm::mat4 proj;
+            int screenWidth, screenHeight;
+
+            // Layout index selects grid position
+            void draw(VertexArray& va, unsigned int layout, const glm::mat4& dequantization, const glm::vec4& texCoordTransform);
+    };
+}
+#endif // __TestPackedVertices__
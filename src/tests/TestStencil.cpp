@@ -1,6 +1,8 @@
 #include "TestStencil.hpp"
 
 #include "../Renderer.hpp"
+#include "../FrameUniforms.hpp"
+#include "../Vertex.hpp"
 
 #include "glm/gtc/matrix_transform.hpp"
 
@@ -15,13 +17,8 @@
 namespace test {
 
     TestStencil::TestStencil() {
-        // TODO: pass screen coords in instead of creating these raw pointers here
-        // to get screen measurements
-        GLFWmonitor* monitor = glfwGetPrimaryMonitor();
-        const GLFWvidmode* mode = glfwGetVideoMode(monitor);
-
-        screenWidth = mode->width;
-        screenHeight = mode->height;
+        screenWidth = getScreenWidth();
+        screenHeight = getScreenHeight();
 
         glEnable(GL_DEPTH_TEST);
         glDepthFunc(GL_LESS);
@@ -93,16 +90,25 @@ namespace test {
         };
 
 
-        vao = std::make_unique<VertexArray>();
-        // 24 vertices with 5 attributes each: 3 position and 3 normal, 2 UV
-        vbo = std::make_unique<VertexBuffer>(positions, 24 * 8 * sizeof(float));
+        // 24 vertices with 3 attributes each: 3 position and 3 normal, 2 UV, split into two streams
+        std::vector<VertexPosition> cubePositionStream(24);
+        std::vector<VertexAttributes> cubeAttributeStream(24);
+        for (unsigned int i = 0; i < 24; i++) {
+            const float* vertex = &positions[i * 8];
+            cubePositionStream[i].Position = glm::vec3(vertex[0], vertex[1], vertex[2]);
+            cubeAttributeStream[i] = {glm::vec3(vertex[3], vertex[4], vertex[5]), glm::vec2(vertex[6], vertex[7])};
+        }
+        positionVbo = std::make_unique<VertexBuffer>(cubePositionStream.data(), 24 * sizeof(VertexPosition));
+        attributeVbo = std::make_unique<VertexBuffer>(cubeAttributeStream.data(), 24 * sizeof(VertexAttributes));
 
-        VertexBufferLayout layout;
-        layout.push<float>(3); // position
-        layout.push<float>(3); // normals
-        layout.push<float>(2); // UV
+        vao = std::make_unique<VertexArray>();
+        vao->setFormats({PositionStreamFormat::view(), AttributeStreamFormat::view()});
+        vao->bindVertexBuffer(0, *positionVbo);
+        vao->bindVertexBuffer(1, *attributeVbo);
 
-        vao->addBuffer(*vbo, layout);
+        positionVao = std::make_unique<VertexArray>();
+        positionVao->setFormat(PositionStreamFormat::view());
+        positionVao->bindVertexBuffer(0, *positionVbo);
 
         // Generate and bind index buffer object
         ibo = std::make_unique<IndexBuffer>(indices, 36);
@@ -123,20 +129,18 @@ namespace test {
 
         floorVao = std::make_unique<VertexArray>();
         floorVbo = std::make_unique<VertexBuffer>(floorPositions, 4 * 8 * sizeof(float));
-        floorVao->addBuffer(*floorVbo, layout);
+        floorVao->addBuffer(*floorVbo, MeshVertexFormat::view());
         floorIbo = std::make_unique<IndexBuffer>(floorIndices, 6);
 
 
+        // Programs are linked in background, uniforms are set once they are ready (see onRender)
         objectShader = std::make_unique<Shader>("assets/shaders/lightCasters.glsl");
-        objectShader->bind();
 
         diffuseMap = std::make_unique<Texture>("assets/textures/container.png");
         specularMap = std::make_unique<Texture>("assets/textures/container_specular.png");
 	// Bind both maps to different slots and set uniforms
         diffuseMap->bind();
 	specularMap->bind(1);
-        objectShader->setUniform1i("material.diffuseMap", 0);
-        objectShader->setUniform1i("material.specularMap", 1);
 
         outlineShader = std::make_unique<Shader>("assets/shaders/mvp.vert", "assets/shaders/outline.frag");
 
@@ -169,6 +173,9 @@ namespace test {
     void TestStencil::onRender() {
 
         GLCall(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT));
+        // Binding would wait for the compiler
+        if (!objectShader->isReady() || !outlineShader->isReady() || !lightSourceShader->isReady())
+            return;
 
         diffuseMap->bind(); // bound to default slot 0
 	specularMap->bind(1);
@@ -192,44 +199,43 @@ namespace test {
         Renderer renderer;
 
         objectShader->bind();
-        objectShader->setUniform1f("material.shininess", 32.0f);
-
-        objectShader->setUniformVec3("dirLight.direction", lightDirection);
-        objectShader->setUniformVec3("dirLight.ambient", dirLightColor * glm::vec3(0.1f));
-        objectShader->setUniformVec3("dirLight.diffuse", dirLightColor * glm::vec3(0.5f));
-        objectShader->setUniform3f("dirLight.specular", 1.0f, 1.0f, 1.0f);
-
-        objectShader->setUniformVec3("pointLight.position", lightPosition);
-        objectShader->setUniformVec3("pointLight.ambient", pointLightColor * glm::vec3(0.1f));
-        objectShader->setUniformVec3("pointLight.diffuse", pointLightColor * glm::vec3(0.2f));
-        objectShader->setUniform3f("pointLight.specular", 1.0f, 1.0f, 1.0f);
-        objectShader->setUniform1f("pointLight.constant", constant);
-        objectShader->setUniform1f("pointLight.linear", linear);
-        objectShader->setUniform1f("pointLight.quadratic", quadratic);
-        // If array of point lights declared, can set each uniform like this:
-        //lightingShader->setUniformVec3("pointLight[0].position", lightPosition);
+        objectShader->setUniform1i(UNIFORM("material.diffuseMap"), 0);
+        objectShader->setUniform1i(UNIFORM("material.specularMap"), 1);
+        objectShader->setUniform1f(UNIFORM("material.shininess"), 32.0f);
+
+        LightConstants lights = {};
+        lights.dirLight.direction = lightDirection;
+        lights.dirLight.ambient = dirLightColor * glm::vec3(0.1f);
+        lights.dirLight.diffuse = dirLightColor * glm::vec3(0.5f);
+        lights.dirLight.specular = glm::vec3(1.0f);
+
+        lights.pointLight.position = lightPosition;
+        lights.pointLight.ambient = pointLightColor * glm::vec3(0.1f);
+        lights.pointLight.diffuse = pointLightColor * glm::vec3(0.2f);
+        lights.pointLight.specular = glm::vec3(1.0f);
+        lights.pointLight.constant = constant;
+        lights.pointLight.linear = linear;
+        lights.pointLight.quadratic = quadratic;
 
         // Make spot light position same as camera thus simulating flashlight!
-        objectShader->setUniformVec3("spotLight.position", camera->Position);
-        objectShader->setUniformVec3("spotLight.direction", camera->Front);
-        objectShader->setUniform1f("spotLight.cutOff", glm::cos(glm::radians(12.5f)));
-        objectShader->setUniform1f("spotLight.outerCutOff", glm::cos(glm::radians(17.5f)));
-        objectShader->setUniformVec3("spotLight.ambient", spotLightColor * glm::vec3(0.2f));
-        objectShader->setUniformVec3("spotLight.diffuse", spotLightColor * glm::vec3(0.9f));
-        objectShader->setUniform3f("spotLight.specular", 1.0f, 1.0f, 1.0f);
-
-
-        objectShader->setUniformVec3("viewPosition", camera->Position);
-
-        objectShader->setUniformMat4f("projection", proj);
-        objectShader->setUniformMat4f("view", view);
+        lights.spotLight.position = camera->Position;
+        lights.spotLight.direction = camera->Front;
+        lights.spotLight.cutOff = glm::cos(glm::radians(12.5f));
+        lights.spotLight.outerCutOff = glm::cos(glm::radians(17.5f));
+        lights.spotLight.ambient = spotLightColor * glm::vec3(0.2f);
+        lights.spotLight.diffuse = spotLightColor * glm::vec3(0.9f);
+        lights.spotLight.specular = glm::vec3(1.0f);
+
+        // Uploaded once, seen by every shader declaring LightConstants and FrameConstants blocks
+        FrameUniforms::setLights(lights);
+        FrameUniforms::setFrame(proj, view, camera->Position);
 
         // Render floor
         // FIXME: For some reason can still see object outlines through the floor, not sure where the problem is
         GLCall(glStencilMask(0x00)); // Make sure not to update stencil buffer while drawing floor
         model = glm::translate(glm::mat4(1.0f), cubePositions[0]);
         model = glm::scale(model, glm::vec3(2.0f, 2.0f, 2.0f));
-        objectShader->setUniformMat4f("model", model);
+        objectShader->setUniformMat4f(UNIFORM("model"), model);
         renderer.draw(*floorVao, *floorIbo, *objectShader);
 
         // Draw objects normally and write to stencil buffer
@@ -238,13 +244,11 @@ namespace test {
         for (unsigned int i = 0; i < 3; i++) {
             model = glm::translate(glm::mat4(1.0f), cubePositions[i]);
             model = glm::scale(model, glm::vec3(2.0f, 2.0f, 2.0f));
-            objectShader->setUniformMat4f("model", model);
+            objectShader->setUniformMat4f(UNIFORM("model"), model);
             renderer.draw(*vao, *ibo, *objectShader);
         }
 
         outlineShader->bind();
-        outlineShader->setUniformMat4f("projection", proj);
-        outlineShader->setUniformMat4f("view", view);
         // disable stencil writing and only draw differences in size, resulting in objects
         // having borders
         GLCall(glStencilFunc(GL_NOTEQUAL, 1, 0xFF));
@@ -254,8 +258,8 @@ namespace test {
         for (unsigned int i = 0; i < 3; i++) {
             model = glm::translate(glm::mat4(1.0f), cubePositions[i]);
             model = glm::scale(model, glm::vec3(2.05f, 2.05f, 2.05f));
-            outlineShader->setUniformMat4f("model", model);
-            renderer.draw(*vao, *ibo, *outlineShader);
+            outlineShader->setUniformMat4f(UNIFORM("model"), model);
+            renderer.draw(*positionVao, *ibo, *outlineShader);
         }
         GLCall(glStencilMask(0xFF));
         GLCall(glStencilFunc(GL_ALWAYS, 0, 0xFF));
@@ -267,9 +271,9 @@ namespace test {
         model = glm::scale(model, glm::vec3(0.5f, 0.5f, 0.5f));
 
         glm::mat4 mvp = proj * view * model;
-        lightSourceShader->setUniformMat4f("u_MVP", mvp);
-        lightSourceShader->setUniform3f("lightColor", pointLightColor.x, pointLightColor.y, pointLightColor.z);
-        renderer.draw(*vao, *ibo, *lightSourceShader);
+        lightSourceShader->setUniformMat4f(UNIFORM("u_MVP"), mvp);
+        lightSourceShader->setUniform3f(UNIFORM("lightColor"), pointLightColor.x, pointLightColor.y, pointLightColor.z);
+        renderer.draw(*positionVao, *ibo, *lightSourceShader);
     }
 
     void TestStencil::onImGuiRender() {
@@ -21,8 +21,12 @@ namespace test {
             void onRender() override;
             void onImGuiRender() override;
         private:
+            // Cube positions and other attributes are in separate streams, outline and light source
+            // passes only need positions and use positionVao, which doesn't fetch the rest
             std::unique_ptr<VertexArray> vao;
-            std::unique_ptr<VertexBuffer> vbo;
+            std::unique_ptr<VertexArray> positionVao;
+            std::unique_ptr<VertexBuffer> positionVbo;
+            std::unique_ptr<VertexBuffer> attributeVbo;
             std::unique_ptr<IndexBuffer> ibo;
 
             std::unique_ptr<VertexArray> floorVao;
@@ -16,16 +16,8 @@ namespace test {
         : r(0.0f), inc(0.05f), translationA(200, 200, 0), translationB(600, 200, 0),
         cameraTranslation(0, 0, 0), scale(0.5), rotation(90.0f) {
 
-        // TODO: pass screen coords in instead of creating these raw pointers here
-        // to get screen measurements
-        GLFWmonitor* monitor = glfwGetPrimaryMonitor();
-        const GLFWvidmode* mode = glfwGetVideoMode(monitor);
-
-        screenWidth = mode->width;
-        screenHeight = mode->height;
-
-        //free(monitor);
-        //free(mode);
+        screenWidth = getScreenWidth();
+        screenHeight = getScreenHeight();
 
         // 1st 2 floats position, 2nd two - tex coords
         float positions [] = {
@@ -74,15 +66,12 @@ namespace test {
         std::cout << "Vertex position as defined by us: "<< glm::to_string(vp) << std::endl;
         std::cout << "Vertex position after being multiplied with projection matrix: "<< glm::to_string(result) << std::endl;
 
+        // Program is linked in background, uniforms are set once it is ready (see onRender)
         shader = std::make_unique<Shader>("assets/shaders/shader.glsl");
-        shader->bind();
-        shader->setUniform4f("u_Color", 0.8f, 0.3f, 0.8f, 1.0f);
 
 
         texture = std::make_unique<Texture>("assets/textures/slime.png");
         texture->bind(); // bound to default slot 0
-        // Set uniform to tell shader that we need to sample texture from slot 0
-        shader->setUniform1i("u_Texture", 0);
 
         glDisable(GL_DEPTH_TEST);
     }
@@ -102,6 +91,9 @@ namespace test {
     void TestTexture2D::onRender() {
         GLCall(glClearColor(0.0f, 0.0f, 0.0f, 1.0f));
         GLCall(glClear(GL_COLOR_BUFFER_BIT));
+        // Binding would wait for the compiler
+        if (!shader->isReady())
+            return;
 
         texture->bind(); // bound to default slot 0
 
@@ -119,8 +111,9 @@ namespace test {
         Renderer renderer;
 
         shader->bind();
-        shader->setUniform4f("u_Color", r, 0.3f, 0.8f, 1.0f);
-        shader->setUniformMat4f("u_MVP", mvpA);
+        shader->setUniform1i(UNIFORM("u_Texture"), 0);
+        shader->setUniform4f(UNIFORM("u_Color"), r, 0.3f, 0.8f, 1.0f);
+        shader->setUniformMat4f(UNIFORM("u_MVP"), mvpA);
         renderer.draw(*vao, *ibo, *shader);
 
         // One way to draw multiple objects is to apply different mvp as in here, which is fast,
@@ -128,7 +121,7 @@ namespace test {
         // save on performance so we use Batch Rendering for that
         glm::mat4 modelB = glm::translate(glm::mat4(1.0f), translationB);
         glm::mat4 mvpB = proj * view * modelB;
-        shader->setUniformMat4f("u_MVP", mvpB);
+        shader->setUniformMat4f(UNIFORM("u_MVP"), mvpB);
         renderer.draw(*vao, *ibo, *shader);
     }
 
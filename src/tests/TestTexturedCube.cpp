@@ -15,13 +15,8 @@ namespace test {
     TestTexturedCube::TestTexturedCube()
         : translation(0, 0, 0), cameraTranslation(0, 0, 0), scale(0.5), rotation(45.0f) {
 
-        // TODO: pass screen coords in instead of creating these raw pointers here
-        // to get screen measurements
-        GLFWmonitor* monitor = glfwGetPrimaryMonitor();
-        const GLFWvidmode* mode = glfwGetVideoMode(monitor);
-
-        screenWidth = mode->width;
-        screenHeight = mode->height;
+        screenWidth = getScreenWidth();
+        screenHeight = getScreenHeight();
 
         // Enable depth testing
         glEnable(GL_DEPTH_TEST);
@@ -116,13 +111,11 @@ namespace test {
         // 3rd and 4th params - near and far planes
         proj = glm::perspective(glm::radians(rotation), (float)screenWidth/(float)screenHeight, 0.1f, 100.0f);
 
+        // Program is linked in background, uniforms are set once it is ready (see onRender)
         shader = std::make_unique<Shader>("assets/shaders/cube_textured.glsl");
-        shader->bind();
 
         texture = std::make_unique<Texture>("assets/textures/dirt.png");
         texture->bind(); // bound to default slot 0
-        // Set uniform to tell shader that we need to sample texture from slot 0
-        shader->setUniform1i("u_Texture", 0);
     }
 
     TestTexturedCube::~TestTexturedCube() {
@@ -134,6 +127,9 @@ namespace test {
     void TestTexturedCube::onRender() {
         GLCall(glClearColor(0.0f, 0.0f, 0.0f, 1.0f));
         GLCall(glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT));
+        // Binding would wait for the compiler
+        if (!shader->isReady())
+            return;
 
         texture->bind(); // bound to default slot 0
 
@@ -167,8 +163,9 @@ namespace test {
             Renderer renderer;
 
             shader->bind();
-            shader->setUniform4f("u_Color", 1.0f, 0.3f, 0.8f, 1.0f);
-            shader->setUniformMat4f("u_MVP", mvp);
+            shader->setUniform1i(UNIFORM("u_Texture"), 0);
+            shader->setUniform4f(UNIFORM("u_Color"), 1.0f, 0.3f, 0.8f, 1.0f);
+            shader->setUniformMat4f(UNIFORM("u_MVP"), mvp);
             renderer.draw(*vao, *ibo, *shader);
         }
     }